@@ -0,0 +1,157 @@
+// bitboard.cpp
+// Attack tables and slider attack generation for the bitboard board representation.
+
+#include "bitboard.h"
+
+Bitboard pawnAttacks[2][64];
+Bitboard knightAttacks[64];
+Bitboard kingAttacks[64];
+
+Magic bishopMagics[64];
+Magic rookMagics[64];
+
+Bitboard betweenBB[64][64];
+Bitboard lineBB[64][64];
+
+namespace {
+    // Row/column steps for each piece. Rows grow towards rank 1.
+    const int knightSteps[8][2] = { {-2,-1}, {-2,1}, {-1,-2}, {-1,2}, {1,-2}, {1,2}, {2,-1}, {2,1} };
+    const int kingSteps[8][2]   = { {-1,-1}, {-1,0}, {-1,1}, {0,-1}, {0,1}, {1,-1}, {1,0}, {1,1} };
+    const int bishopSteps[4][2] = { {-1,-1}, {-1,1}, {1,-1}, {1,1} };
+    const int rookSteps[4][2]   = { {-1,0}, {0,-1}, {0,1}, {1,0} };
+
+    // Magic multipliers for this engine's square numbering (A8 = 0). They were found by
+    // a random search and are only used when the engine is built without USE_PEXT.
+    const Bitboard bishopMagicNumbers[64] = {
+        0x0c08081028882700ULL, 0x0208088820424040ULL, 0x2188480100202561ULL, 0x0004104610800140ULL,
+        0x9004504100002000ULL, 0x0a010108c0010041ULL, 0x3800491028200000ULL, 0x0000802101202002ULL,
+        0x81020410b0810100ULL, 0x0408082808404040ULL, 0x0106220084008008ULL, 0x0040182841001082ULL,
+        0x158404504000800eULL, 0x0888810108432808ULL, 0x0100020811180808ULL, 0x0801420a02410400ULL,
+        0x1320559102103101ULL, 0x0182002002240102ULL, 0xa910000200260020ULL, 0x0008010628210000ULL,
+        0x8002000402114461ULL, 0x0000204410080800ULL, 0x0400500205100900ULL, 0x2002014880840100ULL,
+        0x01e1100108102148ULL, 0x0410090044115400ULL, 0x4004084010104040ULL, 0x0202002008008220ULL,
+        0x0001001105004020ULL, 0x0001081022080400ULL, 0x2018842000820806ULL, 0x40008e0000210401ULL,
+        0x2314104102082200ULL, 0x0002100500101109ULL, 0x1224040201411200ULL, 0x0202004040040102ULL,
+        0x0040002022020080ULL, 0x2020004081210080ULL, 0x0442020404004401ULL, 0x0408c08a00090104ULL,
+        0x0898a21821004003ULL, 0xb004189210424820ULL, 0x8008131088031000ULL, 0x0009010148010500ULL,
+        0x2100084104000040ULL, 0x110102108200a100ULL, 0x0010120801144060ULL, 0x0002020a24200200ULL,
+        0x0020880808040000ULL, 0x0a8b041201040103ULL, 0x0140120205114002ULL, 0x6282000242021201ULL,
+        0x080080140d0c0122ULL, 0x0181102011810200ULL, 0x0804041032420400ULL, 0x0020842c00414142ULL,
+        0x06498028010c2082ULL, 0x0062202084042010ULL, 0x8100000211008800ULL, 0x6000000000840400ULL,
+        0x0018000008210100ULL, 0x00040011a0010100ULL, 0x0820090210020204ULL, 0x0402482804858200ULL,
+    };
+
+    const Bitboard rookMagicNumbers[64] = {
+        0x9880004000102080ULL, 0x9040001000200041ULL, 0x1100200010400900ULL, 0x2080080005801000ULL,
+        0x0200041020080200ULL, 0x0200041041084200ULL, 0x0400080081124410ULL, 0x2180042100004080ULL,
+        0x8000800099644000ULL, 0x0802003040820100ULL, 0x0105801001862000ULL, 0x0101002008100100ULL,
+        0x1000800400080080ULL, 0x0804800200040080ULL, 0x2001800200800900ULL, 0x00160004088204c1ULL,
+        0x228000c001402000ULL, 0x8510004000200050ULL, 0x3001848020029000ULL, 0x0280808010000801ULL,
+        0x0109010010040800ULL, 0x8000808004000200ULL, 0x8000040081021028ULL, 0x40040a0009004884ULL,
+        0x80c0004280008035ULL, 0x0010004040002000ULL, 0x1101200500410070ULL, 0x8410100080080080ULL,
+        0x000c080080800400ULL, 0x4012008080040002ULL, 0x4000040101000200ULL, 0x0061010200008044ULL,
+        0x0080804010800020ULL, 0x3000201008400040ULL, 0x4112008012002444ULL, 0x0848000880801000ULL,
+        0x00a8008008800400ULL, 0x200200280a00500cULL, 0x080a221024004801ULL, 0xc400008042000104ULL,
+        0x8000400080028022ULL, 0x0220008040018020ULL, 0x4000200011010040ULL, 0x10060040210a0010ULL,
+        0x40820020904a0004ULL, 0x0030040002008080ULL, 0x0200020801840010ULL, 0x0084c04100820004ULL,
+        0x4802010080c2a600ULL, 0x0000400080201880ULL, 0x2040801000200080ULL, 0x0180200842001200ULL,
+        0x0013510008000500ULL, 0x0182000c00808a80ULL, 0x1000524821302400ULL, 0x3800040108488200ULL,
+        0x104a004810210082ULL, 0x0004210010420082ULL, 0xc424110008200241ULL, 0x90101000a0088501ULL,
+        0x0182000420100802ULL, 0x4822001001080402ULL, 0x05d0080090012204ULL, 0x2008140089042846ULL,
+    };
+
+    // Per-square slices of these tables hold every attack set. A bishop has at most
+    // 2^9 relevant occupancies and a rook 2^12; the totals are the sums over all squares.
+    Bitboard bishopTable[5248];
+    Bitboard rookTable[102400];
+
+    bool onBoard(int row, int col) {
+        return row >= 0 && row < 8 && col >= 0 && col < 8;
+    }
+
+    // Walk each ray from sq until it leaves the board or hits an occupied square.
+    Bitboard slidingAttacks(int sq, Bitboard occupied, const int steps[4][2]) {
+        Bitboard attacks = 0;
+        for (int d = 0; d < 4; ++d) {
+            int row = ROW(sq) + steps[d][0];
+            int col = COL(sq) + steps[d][1];
+            while (onBoard(row, col)) {
+                Bitboard b = squareBB(SQUARE(row, col));
+                attacks |= b;
+                if (occupied & b) break; // Stop at the first blocker
+                row += steps[d][0];
+                col += steps[d][1];
+            }
+        }
+        return attacks;
+    }
+
+    // Squares that can block a slider on sq: its rays with the final edge square removed.
+    Bitboard relevantMask(int sq, const int steps[4][2]) {
+        Bitboard mask = 0;
+        for (int d = 0; d < 4; ++d) {
+            int row = ROW(sq) + steps[d][0];
+            int col = COL(sq) + steps[d][1];
+            while (onBoard(row + steps[d][0], col + steps[d][1])) {
+                mask |= squareBB(SQUARE(row, col));
+                row += steps[d][0];
+                col += steps[d][1];
+            }
+        }
+        return mask;
+    }
+
+    // Fill in one slider's magic entries. Every subset of each square's mask is
+    // enumerated (Carry-Rippler trick) and its ray-walked attack set stored at its index.
+    void initMagics(Magic magics[64], const Bitboard magicNumbers[64], Bitboard* table, const int steps[4][2]) {
+        Bitboard* next = table;
+        for (int sq = 0; sq < 64; ++sq) {
+            Magic& m = magics[sq];
+            m.mask = relevantMask(sq, steps);
+            m.magic = magicNumbers[sq];
+            m.shift = 64 - popCount(m.mask);
+            m.attacks = next;
+            Bitboard subset = 0;
+            do {
+                m.attacks[m.index(subset)] = slidingAttacks(sq, subset, steps);
+                subset = (subset - m.mask) & m.mask;
+            } while (subset);
+            next += 1ULL << popCount(m.mask);
+        }
+    }
+
+    struct BitboardInit {
+        BitboardInit() { initBitboards(); }
+    } bitboardInit;
+}
+
+void initBitboards() {
+    for (int sq = 0; sq < 64; ++sq) {
+        knightAttacks[sq] = kingAttacks[sq] = 0;
+        for (int i = 0; i < 8; ++i) {
+            if (onBoard(ROW(sq) + knightSteps[i][0], COL(sq) + knightSteps[i][1]))
+                knightAttacks[sq] |= squareBB(SQUARE(ROW(sq) + knightSteps[i][0], COL(sq) + knightSteps[i][1]));
+            if (onBoard(ROW(sq) + kingSteps[i][0], COL(sq) + kingSteps[i][1]))
+                kingAttacks[sq] |= squareBB(SQUARE(ROW(sq) + kingSteps[i][0], COL(sq) + kingSteps[i][1]));
+        }
+        // White pawns capture towards rank 8 (row - 1), Black pawns towards rank 1 (row + 1)
+        Bitboard b = squareBB(sq);
+        pawnAttacks[WHITE][sq] = shiftNorth(shiftWest(b)) | shiftNorth(shiftEast(b));
+        pawnAttacks[BLACK][sq] = shiftSouth(shiftWest(b)) | shiftSouth(shiftEast(b));
+    }
+    initMagics(bishopMagics, bishopMagicNumbers, bishopTable, bishopSteps);
+    initMagics(rookMagics, rookMagicNumbers, rookTable, rookSteps);
+
+    // Two aligned squares see each other on an empty board; what lies between them is
+    // where their attacks towards each other overlap.
+    for (int s1 = 0; s1 < 64; ++s1)
+        for (int s2 = 0; s2 < 64; ++s2) {
+            betweenBB[s1][s2] = lineBB[s1][s2] = 0;
+            for (int pt : { BISHOP, ROOK }) {
+                if (s1 != s2 && (pieceAttacks(pt, s1, 0) & squareBB(s2))) {
+                    lineBB[s1][s2] = (pieceAttacks(pt, s1, 0) & pieceAttacks(pt, s2, 0)) | squareBB(s1) | squareBB(s2);
+                    betweenBB[s1][s2] = pieceAttacks(pt, s1, squareBB(s2)) & pieceAttacks(pt, s2, squareBB(s1));
+                }
+            }
+        }
+}
@@ -0,0 +1,125 @@
+// bitboard.h
+
+#pragma once
+
+#include "engine.h"
+
+#include <cstdint>
+
+#if defined(USE_PEXT)
+#include <immintrin.h>
+#endif
+
+// A Bitboard is a set of squares packed into a 64-bit word.
+// Bit n corresponds to square n of BoardData::pieces, so bit 0 is A8 and bit 63 is H1.
+// Moving one row towards rank 8 is therefore a right shift by 8, and one column
+// towards the H file is a left shift by 1 (masking off the A file to stop wrap-around).
+typedef uint64_t Bitboard;
+
+const Bitboard FILE_A_BB = 0x0101010101010101ULL;
+const Bitboard FILE_B_BB = FILE_A_BB << 1;
+const Bitboard FILE_G_BB = FILE_A_BB << 6;
+const Bitboard FILE_H_BB = FILE_A_BB << 7;
+
+// Rows are numbered as in ROW(sq): row 0 is rank 8, row 7 is rank 1.
+const Bitboard RANK_8_BB = 0xFFULL;
+const Bitboard RANK_7_BB = RANK_8_BB << 8;
+const Bitboard RANK_6_BB = RANK_8_BB << 16;
+const Bitboard RANK_5_BB = RANK_8_BB << 24;
+const Bitboard RANK_4_BB = RANK_8_BB << 32;
+const Bitboard RANK_3_BB = RANK_8_BB << 40;
+const Bitboard RANK_2_BB = RANK_8_BB << 48;
+const Bitboard RANK_1_BB = RANK_8_BB << 56;
+
+constexpr Bitboard squareBB(int sq) {
+    return 1ULL << sq;
+}
+
+inline int popCount(Bitboard b) {
+    return __builtin_popcountll(b);
+}
+
+// Index of the least significant set bit. b must not be empty.
+inline int lsb(Bitboard b) {
+    return __builtin_ctzll(b);
+}
+
+// Returns the least significant square in b and removes it from the set.
+inline int popLsb(Bitboard& b) {
+    int sq = lsb(b);
+    b &= b - 1;
+    return sq;
+}
+
+inline bool moreThanOne(Bitboard b) {
+    return (b & (b - 1)) != 0;
+}
+
+// Shift a whole set one square in a direction, dropping squares that fall off the board.
+inline Bitboard shiftNorth(Bitboard b) { return b >> 8; }
+inline Bitboard shiftSouth(Bitboard b) { return b << 8; }
+inline Bitboard shiftEast(Bitboard b)  { return (b << 1) & ~FILE_A_BB; }
+inline Bitboard shiftWest(Bitboard b)  { return (b >> 1) & ~FILE_H_BB; }
+
+// Leaper attack tables, indexed by square (pawnAttacks also by colour).
+// These and the slider tables below are filled in once at program start by a static
+// initialiser in bitboard.cpp.
+extern Bitboard pawnAttacks[2][64];
+extern Bitboard knightAttacks[64];
+extern Bitboard kingAttacks[64];
+
+// Slider attacks come from "fancy" magic bitboard tables. For each square, mask holds the
+// squares whose occupancy can block the slider (the board edges never matter). The
+// relevant occupancy bits are mapped to a dense index into that square's slice of the
+// attack table, either by multiplying with a magic number and keeping the top bits, or
+// with the BMI2 PEXT instruction when the engine is built with USE_PEXT.
+struct Magic {
+    Bitboard  mask;
+    Bitboard  magic;
+    Bitboard* attacks;
+    unsigned  shift;
+
+    unsigned index(Bitboard occupied) const {
+#if defined(USE_PEXT)
+        return (unsigned)_pext_u64(occupied, mask);
+#else
+        return (unsigned)(((occupied & mask) * magic) >> shift);
+#endif
+    }
+};
+
+extern Magic bishopMagics[64];
+extern Magic rookMagics[64];
+
+// Slider attacks for a piece on sq given the set of occupied squares.
+// The first blocker in each direction is included in the result.
+inline Bitboard bishopAttacks(int sq, Bitboard occupied) {
+    return bishopMagics[sq].attacks[bishopMagics[sq].index(occupied)];
+}
+
+inline Bitboard rookAttacks(int sq, Bitboard occupied) {
+    return rookMagics[sq].attacks[rookMagics[sq].index(occupied)];
+}
+
+inline Bitboard queenAttacks(int sq, Bitboard occupied) {
+    return bishopAttacks(sq, occupied) | rookAttacks(sq, occupied);
+}
+
+// Squares strictly between two squares on a common rank, file or diagonal, and the
+// whole line through them (including both). Both are empty if the squares are not aligned.
+extern Bitboard betweenBB[64][64];
+extern Bitboard lineBB[64][64];
+
+// Attacks of a non-pawn piece type from sq.
+inline Bitboard pieceAttacks(int type, int sq, Bitboard occupied) {
+    switch (type) {
+        case KNIGHT: return knightAttacks[sq];
+        case BISHOP: return bishopAttacks(sq, occupied);
+        case ROOK:   return rookAttacks(sq, occupied);
+        case QUEEN:  return queenAttacks(sq, occupied);
+        case KING:   return kingAttacks[sq];
+        default:     return 0;
+    }
+}
+
+void initBitboards();
@@ -176,6 +176,26 @@ std::string moveToUci(const Move& m) {
     return uci;
 }
 
+PackedMove packMove(const Move& m) {
+    int flag = MOVE_NORMAL;
+    if (m.isCastling) flag = MOVE_CASTLING;
+    else if (m.isEnPassant) flag = MOVE_EN_PASSANT;
+    else if (m.promotion) {
+        switch (tolower(m.promotion)) {
+            case 'n': flag = MOVE_PROMOTION | (KNIGHT - KNIGHT); break;
+            case 'b': flag = MOVE_PROMOTION | (BISHOP - KNIGHT); break;
+            case 'r': flag = MOVE_PROMOTION | (ROOK - KNIGHT); break;
+            default:  flag = MOVE_PROMOTION | (QUEEN - KNIGHT); break;
+        }
+    }
+    return PackedMove(SQUARE(m.fromRow, m.fromCol), SQUARE(m.toRow, m.toCol), flag);
+}
+
+Move unpackMove(PackedMove m) {
+    return Move(ROW(m.from()), COL(m.from()), ROW(m.to()), COL(m.to()),
+                m.isEnPassant(), m.isCastling(), m.isPromotion() ? TYPEtoCHAR(m.promotionType()) : '\0');
+}
+
 Move bookMoveToFullMove(const Move& m, BoardData board) {
     // A book move is not generated by engine so we need to check the position for castling and en passant captures.
     // Decode the given bookMove.
@@ -250,8 +270,11 @@ namespace {
     }
 }
 
+const Zobrist g_zobrist;
+
 Zobrist::Zobrist() {
-    std::mt19937_64 rng(std::chrono::steady_clock::now().time_since_epoch().count());
+    // Fixed seed: keys must be identical across instances, threads and runs
+    std::mt19937_64 rng(0x9E3779B97F4A7C15ULL);
     for (int i = 0; i < 12; ++i)
         for (int j = 0; j < 64; ++j)
             pieceHash[i][j] = rng();
@@ -260,7 +283,7 @@ Zobrist::Zobrist() {
     for (int i = 0; i < 8; ++i) enPassantFileHash[i] = rng();
 }
 
-uint64_t Zobrist::computeHash(const BoardData& board) {
+uint64_t Zobrist::computeHash(const BoardData& board) const {
     uint64_t h = 0;
     for (int sq = 0; sq < 64; ++sq) {
         int idx = pieceToIndex(board.pieces[sq]);
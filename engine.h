@@ -167,6 +167,43 @@ struct Move {
     }
 };
 
+// Move flags stored in the top 4 bits of a PackedMove.
+// Promotions set bit 2 and keep the promoted piece type - KNIGHT in bits 0-1.
+#define MOVE_NORMAL         0
+#define MOVE_CASTLING       1
+#define MOVE_EN_PASSANT     2
+#define MOVE_PROMOTION      4
+
+// A move packed into 16 bits for the search, the transposition table and the killer
+// tables: bits 0-5 hold the from square, bits 6-11 the to square (A8 = 0 ... H1 = 63) and
+// bits 12-15 a MOVE_* flag. Comparing two moves is a single integer compare. The zero
+// value (A8 to A8) is never a legal move and stands for "no move".
+// Move ordering scores are kept next to the moves in MoveList, not in the move itself.
+struct PackedMove {
+    uint16_t data = 0;
+
+    PackedMove() = default;
+    constexpr PackedMove(int from, int to, int flag = MOVE_NORMAL)
+        : data((uint16_t)(from | (to << 6) | (flag << 12))) {}
+
+    constexpr int from() const { return data & 63; }
+    constexpr int to() const   { return (data >> 6) & 63; }
+    constexpr int flag() const { return data >> 12; }
+
+    constexpr bool isNull() const        { return data == 0; }
+    constexpr bool isCastling() const    { return flag() == MOVE_CASTLING; }
+    constexpr bool isEnPassant() const   { return flag() == MOVE_EN_PASSANT; }
+    constexpr bool isPromotion() const   { return (flag() & MOVE_PROMOTION) != 0; }
+    constexpr int  promotionType() const { return KNIGHT + (flag() & 3); }   // Only for promotions
+
+    constexpr bool operator==(PackedMove other) const { return data == other.data; }
+    constexpr bool operator!=(PackedMove other) const { return data != other.data; }
+};
+
+// Convert between the packed move and the Move struct used by UCI, SAN and the book
+PackedMove packMove(const Move& m);
+Move unpackMove(PackedMove m);
+
 // We use an 8x8 square-centric board representation comprising a 64 element char array:
 // char pieces[64] contains:
 // P, N, B, R, Q, K for White pieces or
@@ -262,6 +299,8 @@ std::string moveToUci(const Move& m);
 Move bookMoveToFullMove(const Move& m, BoardData board);
 
 // Zobrist hashing support
+// pieceHash is indexed [0..5] for White P, N, B, R, Q, K and [6..11] for Black.
+// castlingHash is indexed K, Q, k, q.
 struct Zobrist {
     uint64_t pieceHash[12][64];
     uint64_t whiteToMoveHash;
@@ -269,5 +308,9 @@ struct Zobrist {
     uint64_t enPassantFileHash[8];
 
     Zobrist();
-    uint64_t computeHash(const BoardData& board);
+    uint64_t computeHash(const BoardData& board) const;
 };
+
+// The one key set used by the whole process. It is generated from a fixed seed so
+// every thread, every run and every Position agree on the hash of a position.
+extern const Zobrist g_zobrist;
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <vector>
 
 // ---- Evaluation Heuristics -------
@@ -33,9 +34,11 @@ struct EvalMatrix {
 };
 
 // --- History Heuristic (side, from, to) -> score ---
+#define HISTORY_MAX     16384   // Scores stay within +-HISTORY_MAX under update()
+
 struct HistoryTable {
     // Keep it small (int16_t) and clamp
-    // Indices are [side][from][to] side: 0=white, 1=black
+    // Indices are [side][from][to], side being the colour that moves (WHITE or BLACK)
     int16_t h[2][64][64]{};
 
     inline void clear() {
@@ -47,6 +50,12 @@ struct HistoryTable {
         if (x < -32768) x = -32768;
         h[side][from][to] = (int16_t)x;
     }
+    // Bonus (or malus, if negative) that shrinks as the score nears +-HISTORY_MAX,
+    // so scores stay bounded and recent results outweigh old ones
+    inline void update(int side, int from, int to, int bonus) {
+        int x = h[side][from][to];
+        h[side][from][to] = (int16_t)(x + bonus - x * std::abs(bonus) / HISTORY_MAX);
+    }
     // Merge: sum with clamp
     inline void mergeFrom(const HistoryTable& other) {
         for (int s=0; s<2; ++s)
@@ -62,15 +71,15 @@ struct HistoryTable {
 
 // --- Killer moves: top-2 non-captures per ply ---
 struct KillerTable {
-    // Two killers per ply (tune MAX_PLY to your engine); store as ints or your Move
+    // Two killers per ply (tune MAX_PLY to your engine); stored packed
     static constexpr int MAX_PLY = 128;
-    Move k1[MAX_PLY]{};
-    Move k2[MAX_PLY]{};
+    PackedMove k1[MAX_PLY]{};
+    PackedMove k2[MAX_PLY]{};
 
     inline void clear() {
-        for (int i=0; i<MAX_PLY; ++i) { k1[i] = Move{}; k2[i] = Move{}; }
+        for (int i=0; i<MAX_PLY; ++i) { k1[i] = PackedMove{}; k2[i] = PackedMove{}; }
     }
-    inline void add(int ply, Move m) {
+    inline void add(int ply, PackedMove m) {
         if (m == k1[ply] || m == k2[ply]) return;
         k2[ply] = k1[ply];
         k1[ply] = m;
@@ -78,13 +87,13 @@ struct KillerTable {
     // Merge: keep the union best-2 by simple frequency preference
     inline void mergeFrom(const KillerTable& o) {
         for (int p=0; p<MAX_PLY; ++p) {
-            Move cands[4] = {k1[p], k2[p], o.k1[p], o.k2[p]};
+            PackedMove cands[4] = {k1[p], k2[p], o.k1[p], o.k2[p]};
             // Dedup while preserving earlier entries
-            Move out1{}, out2{};
+            PackedMove out1{}, out2{};
             for (int i=0; i<4; ++i) {
-                if (!(cands[i] == Move{})) {
-                    if (out1 == Move{}) out1 = cands[i];
-                    else if (!(cands[i] == out1) && out2 == Move{}) out2 = cands[i];
+                if (!cands[i].isNull()) {
+                    if (out1.isNull()) out1 = cands[i];
+                    else if (cands[i] != out1 && out2.isNull()) out2 = cands[i];
                 }
             }
             k1[p] = out1; k2[p] = out2;
@@ -92,49 +101,37 @@ struct KillerTable {
     }
 };
 
-// --- Transposition Table (simple set/replace by depth) ---
-struct TTEntry {
-    uint64_t key=0;
-    int16_t  score=0;
-    uint8_t  depth=0;
-    uint8_t  flag=0;   // 0 exact, 1 alpha, 2 beta, etc.
-    Move     best{};
-    uint16_t age=0;
+// --- Counter moves: the quiet reply that refuted the opponent's last move ---
+struct CounterMoveTable {
+    // Indexed by the piece code (position.h) of the previous move and its to-square
+    PackedMove m[16][64]{};
+
+    inline void clear() {
+        std::fill(&m[0][0], &m[0][0] + 16*64, PackedMove{});
+    }
 };
 
-class TransTable {
-public:
-    explicit TransTable(size_t sz = 1<<20) : table(sz) {}
-    void clear() { std::fill(table.begin(), table.end(), TTEntry{}); }
+// --- Continuation history: quiet move scores given an earlier move ---
+struct ContinuationHistory {
+    // Indices are [earlier piece][earlier to][piece][to] by piece code. One table serves
+    // both the move one ply back and the one two plies back. It is 2 MB, so it lives on
+    // the heap rather than in each thread's thread_local block.
+    std::vector<int16_t> h;
+
+    ContinuationHistory() : h(16*64*16*64, 0) {}
 
-    inline TTEntry* probePtr(uint64_t key) {
-        return &table[key % table.size()];
+    inline void clear() {
+        std::fill(h.begin(), h.end(), 0);
     }
-    inline bool probe(uint64_t key, TTEntry& out) const {
-        const TTEntry& e = table[key % table.size()];
-        if (e.key == key) { out = e; return true; }
-        return false;
+    inline int16_t& at(int prevPiece, int prevTo, int piece, int to) {
+        return h[((prevPiece * 64 + prevTo) * 16 + piece) * 64 + to];
     }
-    inline void store(uint64_t key, int score, uint8_t depth, uint8_t flag, Move best, uint16_t age) {
-        TTEntry& e = table[key % table.size()];
-        // Replace by depth or empty
-        if (e.key == 0 || depth >= e.depth) {
-            e.key = key; e.score = (int16_t)score; e.depth = depth; e.flag = flag; e.best = best; e.age = age;
-        }
+    inline int score(int prevPiece, int prevTo, int piece, int to) const {
+        return h[((prevPiece * 64 + prevTo) * 16 + piece) * 64 + to];
     }
-    // Merge preferring deeper (or newer age if equal depth)
-    inline void mergeFrom(const TransTable& other) {
-        size_t n = table.size();
-        for (size_t i=0; i<n; ++i) {
-            const TTEntry& src = other.table[i];
-            if (src.key == 0) continue;
-            TTEntry& dst = table[i];
-            if (dst.key == 0 || src.depth > dst.depth || (src.depth == dst.depth && src.age > dst.age)) {
-                dst = src;
-            }
-        }
+    // Same gravity rule as HistoryTable::update
+    inline void update(int prevPiece, int prevTo, int piece, int to, int bonus) {
+        int16_t& x = at(prevPiece, prevTo, piece, to);
+        x = (int16_t)(x + bonus - x * std::abs(bonus) / HISTORY_MAX);
     }
-
-private:
-    std::vector<TTEntry> table;
 };
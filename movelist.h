@@ -0,0 +1,74 @@
+// movelist.h
+
+#pragma once
+
+#include "engine.h"
+
+#include <new>
+#include <vector>
+
+#define MAX_MOVES   256 // No legal chess position has more than 218 moves
+
+// Fixed-capacity list of packed moves, with a move ordering score for each, used by
+// move generation and search.
+//
+// The moves live inside the object, so a MoveList declared as a local variable needs no
+// heap allocation. The storage is left uninitialised until a move is added, which keeps
+// declaring one cheap even though it reserves room for MAX_MOVES moves.
+// It offers the subset of the std::vector interface the engine uses.
+struct MoveList {
+    MoveList() {}
+
+    void push_back(PackedMove m, int score = 0) {
+        new (&moves[count]) PackedMove(m);
+        scores[count++] = score;
+    }
+    void resize(int n) { count = n; }     // Only shrinks the list
+    void clear() { count = 0; }
+
+    int  size() const  { return count; }
+    bool empty() const { return count == 0; }
+
+    PackedMove&       operator[](int i)       { return moves[i]; }
+    const PackedMove& operator[](int i) const { return moves[i]; }
+    int&       score(int i)       { return scores[i]; }
+    const int& score(int i) const { return scores[i]; }
+
+    PackedMove*       begin()       { return moves; }
+    PackedMove*       end()         { return moves + count; }
+    const PackedMove* begin() const { return moves; }
+    const PackedMove* end() const   { return moves + count; }
+
+    // Move m, if present, to the front, keeping the order of the others
+    bool moveToFront(PackedMove m) {
+        for (int i = 0; i < count; ++i) {
+            if (moves[i] == m) {
+                int s = scores[i];
+                for (int j = i; j > 0; --j) {
+                    moves[j] = moves[j - 1];
+                    scores[j] = scores[j - 1];
+                }
+                moves[0] = m;
+                scores[0] = s;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // For the BoardData interfaces, which hand out std::vector<Move>
+    std::vector<Move> toVector() const {
+        std::vector<Move> v;
+        v.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            v.push_back(unpackMove(moves[i]));
+            v.back().score = scores[i];
+        }
+        return v;
+    }
+
+private:
+    union { PackedMove moves[MAX_MOVES]; };   // A union member is not constructed by default
+    int scores[MAX_MOVES];
+    int count = 0;
+};
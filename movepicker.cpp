@@ -0,0 +1,125 @@
+// movepicker.cpp
+// Staged move ordering for the main search.
+
+#include "movepicker.h"
+#include "search.h"
+#include "thread_context.h"
+
+#include <algorithm>
+
+MovePicker::MovePicker(const Position& pos, PackedMove ttMove) : pos(pos), ttMove(ttMove) {
+    int ply = std::min(pos.ply, KillerTable::MAX_PLY - 1);
+    killers[0] = g_ctx.killers.k1[ply];
+    killers[1] = g_ctx.killers.k2[ply];
+    killers[2] = pos.playedPiece(1) != NO_PIECE
+               ? g_ctx.counters.m[pos.playedPiece(1)][pos.playedMove(1).to()] : PackedMove{};
+    // A move from the table may come from another position with the same key
+    stage = (!ttMove.isNull() && isLegalMove(pos, ttMove)) ? STAGE_TT : STAGE_INIT_CAPTURES;
+}
+
+bool MovePicker::isSpecial(PackedMove m) const {
+    return m == ttMove || m == killers[0] || m == killers[1] || m == killers[2];
+}
+
+bool MovePicker::isRepeatedKiller(int i) const {
+    for (int j = 0; j < i; ++j)
+        if (killers[j] == killers[i]) return true;
+    return false;
+}
+
+PackedMove MovePicker::pickBest() {
+    int best = cur;
+    for (int i = cur + 1; i < end; ++i)
+        if (moves.score(i) > moves.score(best)) best = i;
+    PackedMove m = moves[best];
+    int score = moves.score(best);
+    moves[best] = moves[cur];
+    moves.score(best) = moves.score(cur);
+    moves[cur] = m;
+    moves.score(cur) = score;
+    cur++;
+    return m;
+}
+
+PackedMove MovePicker::next() {
+    while (true) {
+        switch (stage) {
+        case STAGE_TT:
+            stage = STAGE_INIT_CAPTURES;
+            return ttMove;
+
+        case STAGE_INIT_CAPTURES:
+            generateMoves(pos, GEN_CAPTURES, moves);
+            cur = 0;
+            end = moves.size();
+            stage = STAGE_GOOD_CAPTURES;
+            break;
+
+        case STAGE_GOOD_CAPTURES:
+            while (cur < end) {
+                PackedMove m = pickBest();
+                if (m == ttMove) continue;
+                if (losingCapture(pos, m)) {
+                    // cur has already passed it, so badCount < cur and nothing unpicked is overwritten
+                    moves[badCount] = m;
+                    moves.score(badCount++) = moves.score(cur - 1);
+                    continue;
+                }
+                return m;
+            }
+            stage = STAGE_KILLERS;
+            break;
+
+        case STAGE_KILLERS:
+            while (killerIndex < 3) {
+                int i = killerIndex++;
+                PackedMove m = killers[i];
+                // Killers are quiet moves stored at this ply by another position
+                if (!m.isNull() && m != ttMove && !isRepeatedKiller(i) && pos.squares[m.to()] == NO_PIECE
+                    && !m.isPromotion() && !m.isEnPassant() && isLegalMove(pos, m))
+                    return m;
+            }
+            stage = STAGE_INIT_QUIETS;
+            break;
+
+        case STAGE_INIT_QUIETS: {
+            // Quiets go after the captures, whose slots from badCount on are free now
+            int side = pos.sideToMove();
+            int prevPiece1 = pos.playedPiece(1), prevTo1 = pos.playedMove(1).to();
+            int prevPiece2 = pos.playedPiece(2), prevTo2 = pos.playedMove(2).to();
+            moves.resize(badCount);
+            generateMoves(pos, GEN_QUIETS, moves);
+            for (int i = badCount; i < moves.size(); ++i) {
+                int from = moves[i].from(), to = moves[i].to();
+                int piece = pos.squares[from];
+                int score = g_ctx.history.h[side][from][to];
+                if (prevPiece1 != NO_PIECE) score += g_ctx.contHistory.score(prevPiece1, prevTo1, piece, to);
+                if (prevPiece2 != NO_PIECE) score += g_ctx.contHistory.score(prevPiece2, prevTo2, piece, to);
+                moves.score(i) = score;
+            }
+            cur = badCount;
+            end = moves.size();
+            stage = STAGE_QUIETS;
+            break;
+        }
+
+        case STAGE_QUIETS:
+            while (cur < end) {
+                PackedMove m = pickBest();
+                if (!isSpecial(m)) return m;
+            }
+            cur = 0;
+            end = badCount;
+            stage = STAGE_BAD_CAPTURES;
+            break;
+
+        case STAGE_BAD_CAPTURES:
+            if (cur < end) return pickBest();
+            stage = STAGE_DONE;
+            break;
+
+        default:
+            return PackedMove{};
+        }
+    }
+}
@@ -0,0 +1,54 @@
+// movepicker.h
+
+#pragma once
+
+#include "engine.h"
+#include "position.h"
+#include "movelist.h"
+
+// Staged, lazy move ordering for the main search.
+//
+// Moves come out in this order, each stage produced only when the ones before it did
+// not end the node with a cutoff:
+//   1. the transposition table move, checked for legality but nothing generated
+//   2. winning and equal captures and promotions, by MVV-LVA; losing ones are set aside
+//   3. the killer moves of this ply and the counter move to the opponent's last move,
+//      if legal here
+//   4. the other quiet moves, by history plus continuation history of the last two plies
+//   5. the losing captures, by MVV-LVA
+// Killers, counter moves and the history tables come from the calling thread's g_ctx.
+class MovePicker {
+public:
+    MovePicker(const Position& pos, PackedMove ttMove);
+
+    // The next move to search, or a null move when there are none left
+    PackedMove next();
+
+private:
+    static constexpr int STAGE_TT            = 0;
+    static constexpr int STAGE_INIT_CAPTURES = 1;
+    static constexpr int STAGE_GOOD_CAPTURES = 2;
+    static constexpr int STAGE_KILLERS       = 3;
+    static constexpr int STAGE_INIT_QUIETS   = 4;
+    static constexpr int STAGE_QUIETS        = 5;
+    static constexpr int STAGE_BAD_CAPTURES  = 6;
+    static constexpr int STAGE_DONE          = 7;
+
+    // Take the best scoring move of moves[cur..end) and advance cur
+    PackedMove pickBest();
+    bool isSpecial(PackedMove m) const;     // Already returned by the TT or killer stage
+    bool isRepeatedKiller(int i) const;     // killers[i] equals one before it
+
+    const Position& pos;
+    PackedMove ttMove;
+    PackedMove killers[3];      // Two killers, then the counter move
+    int stage;
+
+    // Captures, then quiets, share one list. Losing captures found while picking the
+    // captures are moved down to moves[0..badCount), below the ones still to pick.
+    MoveList moves;
+    int cur = 0;
+    int end = 0;
+    int badCount = 0;
+    int killerIndex = 0;
+};
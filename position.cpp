@@ -0,0 +1,255 @@
+// position.cpp
+// Conversion between BoardData and the bitboard Position, and in-place make/unmake move.
+
+#include "position.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+    const char pieceChars[] = ".pnbrqk";
+
+    // Castling rights that survive a move touching each square. A king or rook
+    // leaving its home square, or a rook being captured on it, clears the right.
+    uint8_t castleMask(int sq) {
+        switch (sq) {
+            case A1: return (uint8_t)~CASTLE_WQ;
+            case E1: return (uint8_t)~(CASTLE_WK | CASTLE_WQ);
+            case H1: return (uint8_t)~CASTLE_WK;
+            case A8: return (uint8_t)~CASTLE_BQ;
+            case E8: return (uint8_t)~(CASTLE_BK | CASTLE_BQ);
+            case H8: return (uint8_t)~CASTLE_BK;
+            default: return 0xFF;
+        }
+    }
+
+    // Combined Zobrist key of a set of CASTLE_* rights
+    uint64_t castlingKey(uint8_t rights) {
+        uint64_t k = 0;
+        for (int i = 0; i < 4; ++i)
+            if (rights & (1 << i)) k ^= g_zobrist.castlingHash[i];
+        return k;
+    }
+}
+
+int pieceFromChar(char c) {
+    switch (c) {
+        case 'P': return makePiece(WHITE, PAWN);   case 'p': return makePiece(BLACK, PAWN);
+        case 'N': return makePiece(WHITE, KNIGHT); case 'n': return makePiece(BLACK, KNIGHT);
+        case 'B': return makePiece(WHITE, BISHOP); case 'b': return makePiece(BLACK, BISHOP);
+        case 'R': return makePiece(WHITE, ROOK);   case 'r': return makePiece(BLACK, ROOK);
+        case 'Q': return makePiece(WHITE, QUEEN);  case 'q': return makePiece(BLACK, QUEEN);
+        case 'K': return makePiece(WHITE, KING);   case 'k': return makePiece(BLACK, KING);
+        default:  return NO_PIECE;
+    }
+}
+
+char pieceToChar(int piece) {
+    if (piece == NO_PIECE) return '.';
+    char c = pieceChars[typeOf(piece)];
+    return colorOf(piece) == WHITE ? (char)toupper(c) : c;
+}
+
+void Position::clear() {
+    std::memset(pieceBB, 0, sizeof(pieceBB));
+    colorBB[WHITE] = colorBB[BLACK] = 0;
+    occupied = 0;
+    std::memset(squares, NO_PIECE, sizeof(squares));
+    kingSq[WHITE] = kingSq[BLACK] = -1;
+    whiteToMove = true;
+    castling = 0;
+    enPassantTarget = -1;
+    halfmoveClock = 0;
+    fullmoveNumber = 1;
+    key = 0;
+    ply = 0;
+}
+
+Position::Position(const BoardData& board) {
+    clear();
+    for (int sq = 0; sq < 64; ++sq) {
+        int piece = pieceFromChar(board.pieces[sq]);
+        if (piece != NO_PIECE) putPiece(sq, piece);
+    }
+    whiteToMove = board.whiteToMove;
+    if (board.canCastleK) castling |= CASTLE_WK;
+    if (board.canCastleQ) castling |= CASTLE_WQ;
+    if (board.canCastlek) castling |= CASTLE_BK;
+    if (board.canCastleq) castling |= CASTLE_BQ;
+    enPassantTarget = board.enPassantTarget;
+    halfmoveClock = board.halfmoveClock;
+    fullmoveNumber = board.fullmoveNumber;
+    key = computeKey();
+}
+
+uint64_t Position::computeKey() const {
+    uint64_t k = 0;
+    for (Bitboard b = occupied; b; ) {
+        int sq = popLsb(b);
+        k ^= pieceKey(squares[sq], sq);
+    }
+    if (whiteToMove) k ^= g_zobrist.whiteToMoveHash;
+    k ^= castlingKey(castling);
+    if (enPassantTarget != -1) k ^= g_zobrist.enPassantFileHash[COL(enPassantTarget)];
+    return k;
+}
+
+bool Position::isRepetition() const {
+    // Only positions with the same side to move can match, so step back two plies at a
+    // time, and nothing before the last capture or pawn move can repeat.
+    int limit = std::min(halfmoveClock, ply);
+    for (int i = 4; i <= limit; i += 2)
+        if (undoStack[ply - i].key == key) return true;
+    return false;
+}
+
+BoardData Position::toBoard() const {
+    BoardData board;
+    for (int sq = 0; sq < 64; ++sq)
+        board.pieces[sq] = pieceToChar(squares[sq]);
+    board.whiteToMove = whiteToMove;
+    board.canCastleK = (castling & CASTLE_WK) != 0;
+    board.canCastleQ = (castling & CASTLE_WQ) != 0;
+    board.canCastlek = (castling & CASTLE_BK) != 0;
+    board.canCastleq = (castling & CASTLE_BQ) != 0;
+    board.enPassantTarget = enPassantTarget;
+    board.halfmoveClock = halfmoveClock;
+    board.fullmoveNumber = fullmoveNumber;
+    return board;
+}
+
+void Position::makeMove(PackedMove m) {
+    Undo& u = undoStack[ply++];
+    u.key = key;
+    u.captured = NO_PIECE;
+    u.castling = castling;
+    u.enPassantTarget = (int8_t)enPassantTarget;
+    u.halfmoveClock = (uint16_t)halfmoveClock;
+
+    int side = sideToMove();
+    int from = m.from();
+    int to = m.to();
+    int piece = squares[from];
+    int movingType = typeOf(piece);
+    u.move = m;
+    u.piece = (uint8_t)piece;
+
+    if (m.isEnPassant()) {
+        // The captured pawn sits on the from row, in the to column
+        int capSq = SQUARE(ROW(from), COL(to));
+        u.captured = squares[capSq];
+        key ^= pieceKey(u.captured, capSq);
+        removePiece(capSq);
+    } else if (squares[to] != NO_PIECE) {
+        u.captured = squares[to];
+        key ^= pieceKey(u.captured, to);
+        removePiece(to);
+    }
+
+    movePiece(from, to);
+    key ^= pieceKey(piece, from) ^ pieceKey(piece, to);
+    if (m.isPromotion()) {
+        int promoted = makePiece(side, m.promotionType());
+        removePiece(to);
+        putPiece(to, promoted);
+        key ^= pieceKey(piece, to) ^ pieceKey(promoted, to);
+    }
+
+    if (m.isCastling()) {
+        // The king has been moved above, now move the rook
+        int rook = makePiece(side, ROOK);
+        int rookFrom = -1, rookTo = -1;
+        if (to == G1) { rookFrom = H1; rookTo = F1; }
+        else if (to == C1) { rookFrom = A1; rookTo = D1; }
+        else if (to == G8) { rookFrom = H8; rookTo = F8; }
+        else if (to == C8) { rookFrom = A8; rookTo = D8; }
+        if (rookFrom != -1) {
+            movePiece(rookFrom, rookTo);
+            key ^= pieceKey(rook, rookFrom) ^ pieceKey(rook, rookTo);
+        }
+    }
+
+    uint8_t newCastling = castling & castleMask(from) & castleMask(to);
+    if (newCastling != castling) {
+        key ^= castlingKey(castling ^ newCastling);
+        castling = newCastling;
+    }
+
+    if (enPassantTarget != -1) key ^= g_zobrist.enPassantFileHash[COL(enPassantTarget)];
+    enPassantTarget = -1;
+    if (movingType == PAWN && (from - to == 16 || to - from == 16)) {
+        enPassantTarget = (from + to) / 2;
+        key ^= g_zobrist.enPassantFileHash[COL(enPassantTarget)];
+    }
+
+    if (movingType == PAWN || u.captured != NO_PIECE)
+        halfmoveClock = 0;
+    else
+        halfmoveClock++;
+
+    whiteToMove = !whiteToMove;
+    key ^= g_zobrist.whiteToMoveHash;
+    if (whiteToMove) fullmoveNumber++;
+}
+
+void Position::makeNullMove() {
+    Undo& u = undoStack[ply++];
+    u.key = key;
+    u.move = PackedMove{};
+    u.piece = NO_PIECE;
+    u.captured = NO_PIECE;
+    u.castling = castling;
+    u.enPassantTarget = (int8_t)enPassantTarget;
+    u.halfmoveClock = (uint16_t)halfmoveClock;
+
+    if (enPassantTarget != -1) key ^= g_zobrist.enPassantFileHash[COL(enPassantTarget)];
+    enPassantTarget = -1;
+    halfmoveClock = 0;
+
+    whiteToMove = !whiteToMove;
+    key ^= g_zobrist.whiteToMoveHash;
+    if (whiteToMove) fullmoveNumber++;
+}
+
+void Position::unmakeNullMove() {
+    const Undo& u = undoStack[--ply];
+
+    if (whiteToMove) fullmoveNumber--;
+    whiteToMove = !whiteToMove;
+    enPassantTarget = u.enPassantTarget;
+    halfmoveClock = u.halfmoveClock;
+    key = u.key;
+}
+
+void Position::unmakeMove(PackedMove m) {
+    const Undo& u = undoStack[--ply];
+
+    if (whiteToMove) fullmoveNumber--;
+    whiteToMove = !whiteToMove;
+
+    int side = sideToMove();
+    int from = m.from();
+    int to = m.to();
+
+    if (m.isCastling()) {
+        if (to == G1) movePiece(F1, H1);
+        else if (to == C1) movePiece(D1, A1);
+        else if (to == G8) movePiece(F8, H8);
+        else if (to == C8) movePiece(D8, A8);
+    }
+
+    if (m.isPromotion()) {
+        removePiece(to);
+        putPiece(to, makePiece(side, PAWN));
+    }
+    movePiece(to, from);
+
+    if (u.captured != NO_PIECE)
+        putPiece(m.isEnPassant() ? SQUARE(ROW(from), COL(to)) : to, u.captured);
+
+    castling = u.castling;
+    enPassantTarget = u.enPassantTarget;
+    halfmoveClock = u.halfmoveClock;
+    key = u.key;
+}
@@ -0,0 +1,184 @@
+// position.h
+
+#pragma once
+
+#include "engine.h"
+#include "bitboard.h"
+
+#include <cstdint>
+
+// Castling rights are packed into a 4-bit mask in Position::castling.
+#define CASTLE_WK   1   // White kingside  (K)
+#define CASTLE_WQ   2   // White queenside (Q)
+#define CASTLE_BK   4   // Black kingside  (k)
+#define CASTLE_BQ   8   // Black queenside (q)
+
+// A piece code packs colour and type into one byte: bits 0-2 hold the piece type
+// (PAWN..KING) and bit 3 the colour (WHITE = 1, BLACK = 0). NO_PIECE (0) is an empty square.
+constexpr int makePiece(int color, int type) {
+    return (color << 3) | type;
+}
+
+constexpr int typeOf(int piece) {
+    return piece & 7;
+}
+
+constexpr int colorOf(int piece) {
+    return piece >> 3;
+}
+
+// Convert between piece codes and the FEN/BoardData characters ('P', 'n', '.', ...)
+int pieceFromChar(char c);
+char pieceToChar(int piece);
+
+// Zobrist key of piece on sq, using the Zobrist::pieceHash layout
+inline uint64_t pieceKey(int piece, int sq) {
+    return g_zobrist.pieceHash[(colorOf(piece) == WHITE ? 0 : 6) + typeOf(piece) - 1][sq];
+}
+
+// State that a move destroys and unmakeMove must put back.
+struct Undo {
+    uint64_t key;               // Zobrist key before the move
+    PackedMove move;            // The move itself, kept for move ordering
+    uint8_t  piece;             // Piece code that moved
+    uint8_t  captured;          // Piece code taken by the move, NO_PIECE if none
+    uint8_t  castling;
+    int8_t   enPassantTarget;
+    uint16_t halfmoveClock;
+};
+
+// Bitboard position used by move generation, evaluation and search.
+//
+// It keeps one bitboard per colour and piece type, one per colour, the union of all
+// occupied squares, and a piece-on-square array so "what is on sq" is a single load.
+// Square numbering is the same as BoardData (A8 = 0 ... H1 = 63), so Move rows and
+// columns map straight onto bit indices with SQUARE(row, col).
+//
+// BoardData remains the interchange format for FEN, SAN, the opening book and UCI;
+// convert with Position(board) and toBoard() at those boundaries.
+//
+// The search plays moves in place with makeMove and takes them back with unmakeMove,
+// so each thread recurses on a single Position. Moves must be unmade in reverse order.
+struct Position {
+    static constexpr int MAX_PLY = 256;  // Deepest line makeMove can play from the root
+
+    Bitboard pieceBB[2][PIECE_NB];  // [colour][piece type], index NO_PIECE unused
+    Bitboard colorBB[2];            // All pieces of one colour
+    Bitboard occupied;              // All pieces
+    uint8_t  squares[64];           // Piece code on each square, NO_PIECE when empty
+    int      kingSq[2];             // Square of each king, -1 if it has none
+
+    bool whiteToMove = true;
+    uint8_t castling = 0;           // CASTLE_* flags
+    int enPassantTarget = -1;       // Square index (0-63) or -1 for none
+    int halfmoveClock = 0;
+    int fullmoveNumber = 1;
+
+    // Zobrist key (g_zobrist) of the position. makeMove updates it incrementally and
+    // it always equals g_zobrist.computeHash(toBoard()).
+    uint64_t key = 0;
+
+    Undo undoStack[MAX_PLY];        // One record per move made since the root
+    int  ply = 0;
+
+    Position() { clear(); }
+    explicit Position(const BoardData& board);
+
+    void clear();
+    BoardData toBoard() const;
+    uint64_t computeKey() const;    // Full rescan, used on construction and for testing
+
+    // True if the position already occurred since the last irreversible move,
+    // looking only at moves played on this Position.
+    bool isRepetition() const;
+
+    // The move played `back` plies ago on this Position and the piece code it moved,
+    // or a null move and NO_PIECE if it was played before the Position was set up.
+    PackedMove playedMove(int back) const {
+        return ply >= back ? undoStack[ply - back].move : PackedMove{};
+    }
+    int playedPiece(int back) const {
+        return ply >= back ? undoStack[ply - back].piece : NO_PIECE;
+    }
+
+    // Play m in place (no legality checks) / take back the last move, which must be m.
+    void makeMove(PackedMove m);
+    void unmakeMove(PackedMove m);
+    void makeMove(const Move& m)   { makeMove(packMove(m)); }
+    void unmakeMove(const Move& m) { unmakeMove(packMove(m)); }
+
+    // Pass the turn, for null-move pruning: clears en passant and flips the side to
+    // move. It is recorded as a null move with no piece, and it restarts the halfmove
+    // clock so no position from before the pass counts as a repetition.
+    void makeNullMove();
+    void unmakeNullMove();
+
+    int sideToMove() const {
+        return whiteToMove ? WHITE : BLACK;
+    }
+
+    // Same conventions as BoardData: EMPTY for an empty square
+    int PieceColor(int sq) const {
+        return squares[sq] == NO_PIECE ? EMPTY : colorOf(squares[sq]);
+    }
+
+    int PieceType(int sq) const {
+        return squares[sq] == NO_PIECE ? EMPTY : typeOf(squares[sq]);
+    }
+
+    Bitboard pieces(int color, int type) const {
+        return pieceBB[color][type];
+    }
+
+    int kingSquare(int color) const {
+        return kingSq[color];
+    }
+
+    // Pieces of both colours attacking sq when the occupied squares are `occ`.
+    // Works outward from sq: a piece attacks sq exactly when the same piece type on sq
+    // would attack it, so each piece type costs one table lookup.
+    Bitboard attackersTo(int sq, Bitboard occ) const {
+        return (pawnAttacks[BLACK][sq] & pieceBB[WHITE][PAWN])
+             | (pawnAttacks[WHITE][sq] & pieceBB[BLACK][PAWN])
+             | (knightAttacks[sq] & (pieceBB[WHITE][KNIGHT] | pieceBB[BLACK][KNIGHT]))
+             | (kingAttacks[sq] & (pieceBB[WHITE][KING] | pieceBB[BLACK][KING]))
+             | (bishopAttacks(sq, occ) & (pieceBB[WHITE][BISHOP] | pieceBB[BLACK][BISHOP]
+                                          | pieceBB[WHITE][QUEEN] | pieceBB[BLACK][QUEEN]))
+             | (rookAttacks(sq, occ) & (pieceBB[WHITE][ROOK] | pieceBB[BLACK][ROOK]
+                                        | pieceBB[WHITE][QUEEN] | pieceBB[BLACK][QUEEN]));
+    }
+
+    Bitboard attackersTo(int sq) const {
+        return attackersTo(sq, occupied);
+    }
+
+    void putPiece(int sq, int piece) {
+        Bitboard b = squareBB(sq);
+        if (typeOf(piece) == KING) kingSq[colorOf(piece)] = sq;
+        squares[sq] = (uint8_t)piece;
+        pieceBB[colorOf(piece)][typeOf(piece)] |= b;
+        colorBB[colorOf(piece)] |= b;
+        occupied |= b;
+    }
+
+    void removePiece(int sq) {
+        int piece = squares[sq];
+        Bitboard b = squareBB(sq);
+        if (typeOf(piece) == KING) kingSq[colorOf(piece)] = -1;
+        squares[sq] = NO_PIECE;
+        pieceBB[colorOf(piece)][typeOf(piece)] &= ~b;
+        colorBB[colorOf(piece)] &= ~b;
+        occupied &= ~b;
+    }
+
+    void movePiece(int from, int to) {
+        int piece = squares[from];
+        Bitboard fromTo = squareBB(from) | squareBB(to);
+        if (typeOf(piece) == KING) kingSq[colorOf(piece)] = to;
+        squares[to] = (uint8_t)piece;
+        squares[from] = NO_PIECE;
+        pieceBB[colorOf(piece)][typeOf(piece)] ^= fromTo;
+        colorBB[colorOf(piece)] ^= fromTo;
+        occupied ^= fromTo;
+    }
+};
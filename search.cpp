@@ -3,14 +3,17 @@
 // This file includes:
 // - Move generation and evaluation functions
 // - Alpha-beta pruning with quiescence search
-// - Parallel search using a thread pool
+// - Parallel search: Young Brothers Wait split points on the work-stealing thread pool
 // - Killer move and history heuristic optimizations
 // - Depth/time-limited search using std::chrono and std::atomic
 
 #include "search.h"
 #include "threadpool.h"
 #include "engine.h"
+#include "movepicker.h"
+#include "position.h"
 #include "thread_context.h"
+#include "tt.h"
 #include "fen.h"
 
 #include <limits>
@@ -21,30 +24,17 @@
 #include <chrono>
 #include <atomic>
 #include <cctype>
-
-// Offsets for knight moves (relative index changes on the mailbox64 array)
-const int knightOffsets[8] = { -21, -19, -12, -8, 8, 12, 19, 21 };
-
-// Offsets for bishop moves (diagonals)
-const int bishopOffsets[4] = { -11, -9, 9, 11 };
-
-// Offsets for rook moves (straight lines)
-const int rookOffsets[4] = { -10, -1, 1, 10 };
-
-// Offsets for queen moves (all directions)
-const int queenOffsets[8] = { -11, -10, -9, -1, 1, 9, 10, 11 };
-
-// Offsets for king moves (all directions)
-const int kingOffsets[8] = { -11, -10, -9, -1, 1, 9, 10, 11 };
+#include <mutex>
+#include <cmath>
 
 const int INF = std::numeric_limits<int>::max();
 const int MAX_DEPTH = 64;
 
+bool g_selectiveSearch = true;
+
 std::array<std::vector<Move>, MAX_DEPTH> killerMoves;
 std::unordered_map<uint64_t, int> historyHeuristic;
 
-std::atomic<uint64_t> g_nodes{0};  // <-- define the counter
-
 bool isSameMove(const Move& a, const Move& b) {
     return a.fromRow == b.fromRow && a.fromCol == b.fromCol &&
            a.toRow == b.toRow && a.toCol == b.toCol;
@@ -64,98 +54,92 @@ bool isSameMove(const Move& a, const Move& b) {
 // }
 
 // ----------------------- Static evaluator (White positive) -------------------
-int evaluate(const BoardData& state) {
-    if (state.halfmoveClock >= 100)
+int evaluate(const Position& pos) {
+    if (pos.halfmoveClock >= 100)
         return 0; // Draw evaluation due to 50-move rule
 
     int score[2];   // The accumulated score for each color
-    int color;      // Piece Color 
-    int pt;         // Piece Type
-    int file = 0;
+    Bitboard b;
+    int sq;
 
     g_ctx.eval.clear();  // Initialise the evaluation matrix before every evaluation
 
     // Calculate the new values for pawn_rank, piece_mat & pawn_mat
-    for (int i = 0; i < 64; ++i) {
-        color = state.PieceColor(i);    // Get Piece Color 
-        pt = state.PieceType(i);        // Get Piece Type
-        if (color == EMPTY)
-            continue;
-        if (pt == PAWN) {
-            g_ctx.eval.pawn_mat[color] += piece_value[PAWN];
-            file = COL(i) + 1;  // add 1 to the column because of the extra files in the array at 0 and 9
+    for (int color = BLACK; color <= WHITE; ++color) {
+        b = pos.pieces(color, PAWN);
+        g_ctx.eval.pawn_mat[color] = piece_value[PAWN] * popCount(b);
+        while (b) {
+            sq = popLsb(b);
+            int file = COL(sq) + 1;  // add 1 to the column because of the extra files in the array at 0 and 9
+            // Record the least advanced pawn on each file
             if (color == WHITE) {
-                if (g_ctx.eval.pawn_rank[WHITE][file] < ROW(i)) g_ctx.eval.pawn_rank[BLACK][file] = ROW(i);
+                if (g_ctx.eval.pawn_rank[WHITE][file] < ROW(sq)) g_ctx.eval.pawn_rank[WHITE][file] = ROW(sq);
             }
             else {
-                if (g_ctx.eval.pawn_rank[BLACK][file] > ROW(i)) g_ctx.eval.pawn_rank[BLACK][file] = ROW(i);
+                if (g_ctx.eval.pawn_rank[BLACK][file] > ROW(sq)) g_ctx.eval.pawn_rank[BLACK][file] = ROW(sq);
             }
         }
-        else
-            g_ctx.eval.piece_mat[color] += piece_value[pt];
+        for (int pt = KNIGHT; pt <= QUEEN; ++pt)
+            g_ctx.eval.piece_mat[color] += piece_value[pt] * popCount(pos.pieces(color, pt));
     }
-    
+
     // Now initialise the scores and evaluate each piece
     score[WHITE] = g_ctx.eval.piece_mat[WHITE] + g_ctx.eval.pawn_mat[WHITE];
 	score[BLACK] = g_ctx.eval.piece_mat[BLACK] + g_ctx.eval.pawn_mat[BLACK];
-    for (int i = 0; i < 64; ++i) {
-        pt = state.PieceType(i); // Get Piece Type
-        if (pt == EMPTY) continue;
-        switch (pt) {
-            case PAWN:
-                if (color == WHITE) score[WHITE] += eval_white_pawn(i);
-                else score[BLACK] += eval_black_pawn(i);
-                break;
-            case KNIGHT:
-                if (color == WHITE) score[WHITE] += knight_pcsq[i];
-                else score[BLACK] += knight_pcsq[mirror[i]];
-                break;
-            case BISHOP:
-                if (color == WHITE) score[WHITE] += bishop_pcsq[i];
-                else score[BLACK] += bishop_pcsq[mirror[i]];
-                break;
-            case ROOK:
-                if (color == WHITE) {
-                    if (g_ctx.eval.pawn_rank[WHITE][COL(i) + 1] == 0) {
-						if (g_ctx.eval.pawn_rank[BLACK][COL(i) + 1] == 7)
-							score[WHITE] += ROOK_OPEN_FILE_BONUS;
-						else
-							score[WHITE] += ROOK_SEMI_OPEN_FILE_BONUS;
-					}
-					if (ROW(i) == 1)
-						score[WHITE] += ROOK_ON_SEVENTH_BONUS;
-                }
-                else {
-                    if (g_ctx.eval.pawn_rank[BLACK][COL(i) + 1] == 7) {
-						if (g_ctx.eval.pawn_rank[BLACK][COL(i) + 1] == 0)
-							score[BLACK] += ROOK_OPEN_FILE_BONUS;
-						else
-							score[BLACK] += ROOK_SEMI_OPEN_FILE_BONUS;
-					}
-					if (ROW(i) == 6)
-						score[BLACK] += ROOK_ON_SEVENTH_BONUS;
-                }
-                break;
-            case KING:
-                if (color == WHITE) {
-                    if (g_ctx.eval.piece_mat[BLACK] <= 1200)
-						score[WHITE] += king_endgame_pcsq[i];
-					else
-                        score[WHITE] += eval_white_king(i);
-                }
-                else {
-                    if (g_ctx.eval.piece_mat[WHITE] <= 1200)
-						score[BLACK] += king_endgame_pcsq[mirror[i]];
-					else
-                        score[BLACK] += eval_black_king(i);
-                }
-                break;
-        } 
+
+    for (b = pos.pieces(WHITE, PAWN); b; ) score[WHITE] += eval_white_pawn(popLsb(b));
+    for (b = pos.pieces(BLACK, PAWN); b; ) score[BLACK] += eval_black_pawn(popLsb(b));
+    for (b = pos.pieces(WHITE, KNIGHT); b; ) score[WHITE] += knight_pcsq[popLsb(b)];
+    for (b = pos.pieces(BLACK, KNIGHT); b; ) score[BLACK] += knight_pcsq[mirror[popLsb(b)]];
+    for (b = pos.pieces(WHITE, BISHOP); b; ) score[WHITE] += bishop_pcsq[popLsb(b)];
+    for (b = pos.pieces(BLACK, BISHOP); b; ) score[BLACK] += bishop_pcsq[mirror[popLsb(b)]];
+
+    for (b = pos.pieces(WHITE, ROOK); b; ) {
+        sq = popLsb(b);
+        if (g_ctx.eval.pawn_rank[WHITE][COL(sq) + 1] == 0) {
+            if (g_ctx.eval.pawn_rank[BLACK][COL(sq) + 1] == 7)
+                score[WHITE] += ROOK_OPEN_FILE_BONUS;
+            else
+                score[WHITE] += ROOK_SEMI_OPEN_FILE_BONUS;
+        }
+        if (ROW(sq) == 1)
+            score[WHITE] += ROOK_ON_SEVENTH_BONUS;
+    }
+    for (b = pos.pieces(BLACK, ROOK); b; ) {
+        sq = popLsb(b);
+        if (g_ctx.eval.pawn_rank[BLACK][COL(sq) + 1] == 7) {
+            if (g_ctx.eval.pawn_rank[WHITE][COL(sq) + 1] == 0)
+                score[BLACK] += ROOK_OPEN_FILE_BONUS;
+            else
+                score[BLACK] += ROOK_SEMI_OPEN_FILE_BONUS;
+        }
+        if (ROW(sq) == 6)
+            score[BLACK] += ROOK_ON_SEVENTH_BONUS;
+    }
+
+    if (pos.pieces(WHITE, KING)) {
+        sq = pos.kingSquare(WHITE);
+        if (g_ctx.eval.piece_mat[BLACK] <= 1200)
+            score[WHITE] += king_endgame_pcsq[sq];
+        else
+            score[WHITE] += eval_white_king(sq);
     }
+    if (pos.pieces(BLACK, KING)) {
+        sq = pos.kingSquare(BLACK);
+        if (g_ctx.eval.piece_mat[WHITE] <= 1200)
+            score[BLACK] += king_endgame_pcsq[mirror[sq]];
+        else
+            score[BLACK] += eval_black_king(sq);
+    }
+
     // Return the score relative to White positive
     return score[WHITE] - score[BLACK];
 }
 
+int evaluate(const BoardData& state) {
+    return evaluate(Position(state));
+}
+
 int eval_white_pawn(int sq)
 {
 	int r;  /* the value to return */
@@ -338,675 +322,369 @@ bool isCheckMate(const BoardData& board, const Move& move) {
     return false; // Escape moves exist, not checkmate
 }
 
-bool inCheck(const BoardData& board, int side) {
+bool inCheck(const Position& pos, int side) {
     // Returns true only if the colour side is in check
-    int oside;
-    if (side == WHITE) { oside = BLACK; }
-    else { oside = WHITE; }
-    for (int i = 0; i < 64; ++i) {
-        if (board.PieceType(i) == KING && board.PieceColor(i) == side) {
-            return attacked(board, i, oside);
-        }
-    }
-    return true; // If no king found, assume in check
+    int king = pos.kingSquare(side);
+    if (king < 0) return true; // If no king found, assume in check
+    return attacked(pos, king, side ^ 1);
 }
 
-bool attacked(const BoardData& board, int sq, int side) {
+bool inCheck(const BoardData& board, int side) {
+    return inCheck(Position(board), side);
+}
+
+bool attacked(const Position& pos, int sq, int side) {
     // Returns true only if the square sq is attacked by at least one piece of colour side
-    int i, j, n;
-
-    for (i = 0; i < 64; ++i) {
-        if (board.PieceColor(i) == side) {
-            // If the colour of the piece on square i matches the side to move
-            if (board.PieceType(i) == PAWN) {
-                if (side == WHITE) { // Generate White pawn captures
-                    if (COL(i) != 0 && i - 9 == sq) {
-                        return true;
-                    }
-                    if (COL(i) != 7 && i - 7 == sq) {
-                        return true;
-                    }
-                } else { // Generate Black pawn captures
-                    if (COL(i) != 0 && i + 7 == sq) {
-                        return true;
-                    }
-                    if (COL(i) != 7 && i + 9 == sq) {
-                        return true;
-                    }
-                } 
-            } else { // Generate attacks for other piece types
-                switch (board.PieceType(i)) {
-                    case KNIGHT: // Knight moves
-                        for (j = 0; j < 8; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + knightOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (n == sq) return true; // Found an attack on the target square
-                                if (board.PieceColor(n) != EMPTY) break; // Stop at enemy piece 
-                                // This piece does not slide (e.g. king or knight), so stop after one move in any direction
-                                break;
-                            }
-                        }
-                        break;
-                    case BISHOP: // Bishop moves
-                        for (j = 0; j < 4; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + bishopOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (n == sq) return true; // Found an attack on the target square
-                                if (board.PieceColor(n) != EMPTY) break; // Stop at enemy piece
-                            }
-                        }
-                        break;
-                    case ROOK: // Rook moves
-                        for (j = 0; j < 4; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + rookOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (n == sq) return true; // Found an attack on the target square
-                                if (board.PieceColor(n) != EMPTY) break; // Stop at enemy piece
-                            }
-                        }
-                        break;
-                    case QUEEN: // Queen moves
-                        for (j = 0; j < 8; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + queenOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (n == sq) return true; // Found an attack on the target square
-                                if (board.PieceColor(n) != EMPTY) break; // Stop at enemy piece
-                            }
-                        }
-                        break;
-                    case KING: // King moves
-                        for (j = 0; j < 8; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + kingOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (n == sq) return true; // Found an attack on the target square
-                                if (board.PieceColor(n) != EMPTY) break; // Stop at enemy piece
-                                // This piece does not slide (e.g. king or knight), so stop after one move in any direction
-                                break;
-                            }
-                        }
-                        break;
-                    default:
-                    // Invalid piece type, do nothing
-                    break;   
-                }
-            }
-        }
-    }
-    return false; // No attack found
+    return (pos.attackersTo(sq) & pos.colorBB[side]) != 0;
+}
+
+bool attacked(const BoardData& board, int sq, int side) {
+    return attacked(Position(board), sq, side);
 }
 
 bool pawn_attack(const BoardData& board, int sq, int side) {
-    // Returns true only if the square sq is attacked by at least one pawn of colour side
-    int i;
+    // Returns true only if the square sq is attacked by at least one pawn of colour side.
+    // A pawn of colour side attacks sq exactly when a pawn of the other colour on sq would attack it.
+    Position pos(board);
+    return (pawnAttacks[side ^ 1][sq] & pos.pieces(side, PAWN)) != 0;
+}
 
-    for (i = 0; i < 64; ++i) {
-        if (board.PieceColor(i) == side) {
-            // If the colour of the piece on square i matches the side to move
-            if (board.PieceType(i) == PAWN) {
-                if (side == WHITE) { // Generate White pawn captures
-                    if (COL(i) != 0 && i - 9 == sq) {
-                        return true;
-                    }
-                    if (COL(i) != 7 && i - 7 == sq) {
-                        return true;
-                    }
-                } else { // Generate Black pawn captures
-                    if (COL(i) != 0 && i + 7 == sq) {
-                        return true;
-                    }
-                    if (COL(i) != 7 && i + 9 == sq) {
-                        return true;
-                    }
-                } 
-            } 
-        }
+// Piece values for exchanges. The king is worth more than everything else together,
+// so capturing with it into a defended square always loses.
+static const int see_value[PIECE_NB] = {
+    0, 100, 320, 330, 500, 900, 20000
+};
+
+int see(const Position& pos, PackedMove m) {
+    // Static Exchange Evaluation with a swap list: both sides recapture on the target
+    // square with their least valuable attacker, and gain[d] is what the side making
+    // capture d wins if the exchange stops after it. Sliders behind a capturing piece
+    // join in (x-rays) as each attacker is taken off the board. Pins are not considered.
+    if (m.isCastling()) return 0;
+    int from = m.from();
+    int to = m.to();
+    int side = colorOf(pos.squares[from]);
+    int attacker = typeOf(pos.squares[from]);
+    Bitboard occupied = pos.occupied;
+    Bitboard diagonal = pos.pieces(WHITE, BISHOP) | pos.pieces(BLACK, BISHOP) | pos.pieces(WHITE, QUEEN) | pos.pieces(BLACK, QUEEN);
+    Bitboard straight = pos.pieces(WHITE, ROOK) | pos.pieces(BLACK, ROOK) | pos.pieces(WHITE, QUEEN) | pos.pieces(BLACK, QUEEN);
+
+    int gain[64];    // One entry per capture, so at most one per piece
+    int d = 0;
+    gain[0] = pos.squares[to] != NO_PIECE ? see_value[typeOf(pos.squares[to])] : 0;
+    if (m.isEnPassant()) {
+        gain[0] = see_value[PAWN];
+        occupied ^= squareBB(to + (side == WHITE ? 8 : -8));
+    }
+    if (m.isPromotion()) {
+        gain[0] += see_value[m.promotionType()] - see_value[PAWN];
+        attacker = m.promotionType();
+    }
+
+    Bitboard attackers = pos.attackersTo(to, occupied);
+    while (true) {
+        // The piece on `to` is now `attacker`; gain if the other side takes it next
+        d++;
+        gain[d] = see_value[attacker] - gain[d - 1];
+        // Neither side can do better by going on, whatever the rest of the exchange
+        if (std::max(-gain[d - 1], gain[d]) < 0) break;
+
+        occupied ^= squareBB(from);
+        attackers |= (bishopAttacks(to, occupied) & diagonal) | (rookAttacks(to, occupied) & straight);
+        attackers &= occupied;
+
+        side ^= 1;
+        Bitboard ours = attackers & pos.colorBB[side];
+        if (!ours) break;
+        for (attacker = PAWN; !(ours & pos.pieces(side, attacker)); ++attacker) {}
+        from = lsb(ours & pos.pieces(side, attacker));
     }
-    return false; // No attack found
+    // Each side may stop capturing whenever that is better for it
+    while (--d) gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    return gain[0];
 }
 
-// Generate all pseudo legal moves for the current board state
-// Returns a vector of Move objects containing all pseudo legal moves
-std::vector<Move> generatePseudoLegalMoves(const BoardData& board) {
-    std::vector<Move> Moves;
-    int i, j, n;
-    int side, xside;
-    int score = 0;
-    char p;
-
-    if (board.whiteToMove) { side = WHITE; xside = BLACK; }
-    else { side = BLACK; xside = WHITE; }
-    
-    for (i = 0; i < 64; ++i) {
-        if (board.PieceColor(i) == side) {
-            // If the colour of the piece on square i matches the side to move
-            if (board.PieceType(i) == PAWN) {
-                // Generate pawn moves
-                if (side == WHITE) {
-                    // White pawns move up the board in steps of -8 (or -16 if they are still on their starting rank)
-                    // White pawns start on rank 2 (row 6) squares 48 to 55
-                    if (board.PieceType(i - 8) == EMPTY) {
-                        if (ROW(i - 8) == 0) {
-                            // White pawn moving to last rank so generate promotion moves
-                            for (int k = KNIGHT; k <= QUEEN; ++k) {
-                                // Provide the promotion piece and a high score for promotion moves
-                                Moves.push_back({ROW(i), COL(i), ROW(i - 8), COL(i - 8), false, false, TYPEtoCHAR(k), (1000000 + (k * 10))});
-                            }
-                        } else {
-                            Moves.push_back({ROW(i), COL(i), ROW(i - 8), COL(i - 8)}); // Pawn move one square forward
-                        }
-                        if (i >= 48 && board.PieceType(i - 16) == EMPTY) {
-                            Moves.push_back({ROW(i), COL(i), ROW(i - 16), COL(i - 16)}); // Pawn move two squares forward
-                        }
-                    }
-                    if (COL(i) != 0 && board.PieceColor(i - 9) == BLACK) {
-                        // White pawn making a capture
-                        if (ROW(i - 9) == 0) {
-                            // White pawn moving to last rank so generate promotion moves
-                            for (int k = KNIGHT; k <= QUEEN; ++k) {
-                                // Provide the promotion piece and a high score for promotion moves
-                                score = (1000000 + (k * 10));
-                                Moves.push_back({ROW(i), COL(i), ROW(i - 9), COL(i - 9), false, false, TYPEtoCHAR(k), score});
-                            }
-                        } else {
-                            // If the move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                            score = (1000000 + (board.PieceType(i - 9) * 10) - board.PieceType(i));
-                            Moves.push_back({ROW(i), COL(i), ROW(i - 9), COL(i - 9), false, false, '\0', score});
-                        }
-                    }
-                    if (COL(i) != 7 && board.PieceColor(i - 7) == BLACK) {
-                        // White pawn making a capture
-                        if (ROW(i - 7) == 0) {
-                            // White pawn moving to last rank so generate promotion moves
-                            for (int k = KNIGHT; k <= QUEEN; ++k) {
-                                // Provide the promotion piece and a high score for promotion moves
-                                score = (1000000 + (k * 10));
-                                Moves.push_back({ROW(i), COL(i), ROW(i - 7), COL(i - 7), false, false, TYPEtoCHAR(k), score});
-                            }
-                        } else {
-                            // If the move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                            score = (1000000 + (board.PieceType(i - 7) * 10) - board.PieceType(i));
-                            Moves.push_back({ROW(i), COL(i), ROW(i - 7), COL(i - 7), false, false, '\0', score});
-                        }
-                    }
-                } else { // Black pawns move down the board in steps of +8 (or +16 if they are still on their starting rank)
-                    // Black pawns start on rank 7 (row 1) squares 8 to 15
-                    if (board.PieceType(i + 8) == EMPTY) {
-                        if (ROW(i + 8) == 7) {
-                            // Black pawn moving to last rank so generate promotion moves
-                            for (int k = KNIGHT; k <= QUEEN; ++k) {
-                                // Provide the promotion piece and a high score for promotion moves
-                                Moves.push_back({ROW(i), COL(i), ROW(i + 8), COL(i + 8), false, false, TYPEtoCHAR(k), (1000000 + (k * 10))});
-                            }
-                        } else {
-                            Moves.push_back({ROW(i), COL(i), ROW(i + 8), COL(i + 8)}); // Pawn move one square forward
-                        }
-                        if (i < 16 && board.PieceType(i + 16) == EMPTY) {
-                            Moves.push_back({ROW(i), COL(i), ROW(i + 16), COL(i + 16)}); // Pawn move two squares forward
-                        }
-                    }
-                    if (COL(i) != 0 && board.PieceColor(i + 7) == WHITE) {
-                        // Black pawn making a capture
-                        if (ROW(i + 7) == 7) {
-                            // Black pawn moving to last rank so generate promotion moves
-                            for (int k = KNIGHT; k <= QUEEN; ++k) {
-                                // Provide the promotion piece and a high score for promotion moves
-                                score =  (1000000 + (k * 10));
-                                Moves.push_back({ROW(i), COL(i), ROW(i + 7), COL(i + 7), false, false, TYPEtoCHAR(k), score});
-                            }
-                        } else {
-                            // If the move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                            score = (1000000 + (board.PieceType(i + 7) * 10) - board.PieceType(i));
-                            Moves.push_back({ROW(i), COL(i), ROW(i + 7), COL(i + 7), false, false, '\0', score});
-                        }
-                    }
-                    if (COL(i) != 7 && board.PieceColor(i + 9) == WHITE) {
-                        // Black pawn making a capture
-                        if (ROW(i + 9) == 7) {
-                            // Black pawn moving to last rank so generate promotion moves
-                            for (int k = KNIGHT; k <= QUEEN; ++k) {
-                                // Provide the promotion piece and a high score for promotion moves
-                                score = (1000000 + (k * 10));
-                                Moves.push_back({ROW(i), COL(i), ROW(i + 9), COL(i + 9), false, false, TYPEtoCHAR(k), score});
-                            }
-                        } else {
-                            // If the move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                            score = (1000000 + (board.PieceType(i + 9) * 10) - board.PieceType(i));
-                            Moves.push_back({ROW(i), COL(i), ROW(i + 9), COL(i + 9), false, false, '\0', score});
-                        }
-                    }
-                }
-            } else {// Generate moves for other piece types
-                switch (board.PieceType(i)) {
-                    case KNIGHT: // Knight moves
-                        for (j = 0; j < 8; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + knightOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (board.PieceColor(n) != EMPTY) {
-                                    if (board.PieceColor(n) == xside) {
-                                        // Move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                                        score = (1000000 + (board.PieceType(n) * 10) - board.PieceType(i));
-                                        Moves.push_back({ROW(i), COL(i), ROW(n), COL(n), false, false, '\0', score});
-                                    }
-                                    break; // Stop at enemy piece
-                                }    
-                                Moves.push_back({ROW(i), COL(i), ROW(n), COL(n)}); // Add quiet move to empty square
-                                // This piece does not slide (e.g. king or knight), so stop after one move in any direction
-                                break;
-                            }
-                        }
-                        break;
-                    case BISHOP: // Bishop moves
-                        for (j = 0; j < 4; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + bishopOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (board.PieceColor(n) != EMPTY) {
-                                    if (board.PieceColor(n) == xside) {
-                                        // Move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                                        score = (1000000 + (board.PieceType(n) * 10) - board.PieceType(i));
-                                        Moves.push_back({ROW(i), COL(i), ROW(n), COL(n), false, false, '\0', score});
-                                    }
-                                    break; // Stop at enemy piece
-                                }    
-                                Moves.push_back({ROW(i), COL(i), ROW(n), COL(n)}); // Add quiet move to empty square
-                            }
-                        }
-                        break;
-                    case ROOK: // Rook moves
-                        for (j = 0; j < 4; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + rookOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (board.PieceColor(n) != EMPTY) {
-                                    if (board.PieceColor(n) == xside) {
-                                        // Move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                                        score = (1000000 + (board.PieceType(n) * 10) - board.PieceType(i));
-                                        Moves.push_back({ROW(i), COL(i), ROW(n), COL(n), false, false, '\0', score});
-                                    }
-                                    break; // Stop at enemy piece
-                                }    
-                                Moves.push_back({ROW(i), COL(i), ROW(n), COL(n)}); // Add quiet move to empty square
-                            }
-                        }
-                        break;
-                    case QUEEN: // Queen moves
-                        for (j = 0; j < 8; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + queenOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (board.PieceColor(n) != EMPTY) {
-                                    if (board.PieceColor(n) == xside) {
-                                        // Move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                                        score = (1000000 + (board.PieceType(n) * 10) - board.PieceType(i));
-                                        Moves.push_back({ROW(i), COL(i), ROW(n), COL(n), false, false, '\0', score});
-                                    }
-                                    break; // Stop at enemy piece
-                                }    
-                                Moves.push_back({ROW(i), COL(i), ROW(n), COL(n)}); // Add quiet move to empty square
-                            }
-                        }
-                        break;
-                    case KING: // King moves
-                        for (j = 0; j < 8; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + kingOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (board.PieceColor(n) != EMPTY) {
-                                    if (board.PieceColor(n) == xside) {
-                                        // Move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                                        score = (1000000 + (board.PieceType(n) * 10) - board.PieceType(i));
-                                        Moves.push_back({ROW(i), COL(i), ROW(n), COL(n), false, false, '\0', score});
-                                    }
-                                    break; // Stop at enemy piece
-                                }    
-                                Moves.push_back({ROW(i), COL(i), ROW(n), COL(n)}); // Add quiet move to empty square
-                                // This piece does not slide (e.g. king or knight), so stop after one move in any direction
-                                break;
-                            }
-                        }
-                        break;
-                    default:
-                    // Invalid piece type, do nothing
-                    break;   
-                }
+bool losingCapture(const Position& pos, PackedMove m) {
+    // A victim worth at least its attacker cannot lose, so SEE only runs for the others
+    if (m.isPromotion() || m.isEnPassant()) return false;
+    if (see_value[typeOf(pos.squares[m.to()])] >= see_value[typeOf(pos.squares[m.from()])]) return false;
+    return see(pos, m) < 0;
+}
+
+// What a legal move must respect, computed once per generated position.
+// The pseudo legal generator uses no pins, an unrestricted check mask and no king filter.
+struct MoveMasks {
+    bool legal = false;             // Filter moves that would leave the king in check
+    int kingSq = -1;
+    Bitboard checkers = 0;          // Enemy pieces giving check
+    Bitboard pinned = 0;            // Our pieces pinned to our king
+    Bitboard checkMask = ~0ULL;     // Destinations that capture or block a single checker
+};
+
+static MoveMasks legalMasks(const Position& pos) {
+    int side = pos.sideToMove();
+    int xside = side ^ 1;
+    MoveMasks mm;
+    mm.legal = true;
+    mm.kingSq = pos.kingSquare(side);
+    if (mm.kingSq < 0) return mm;               // No king: no legal moves, as for inCheck
+    mm.checkers = pos.attackersTo(mm.kingSq) & pos.colorBB[xside];
+
+    // A single checker is captured or blocked; against two only the king can move
+    if (mm.checkers)
+        mm.checkMask = moreThanOne(mm.checkers) ? 0 : betweenBB[mm.kingSq][lsb(mm.checkers)] | mm.checkers;
+
+    // Enemy sliders that would see our king through exactly one of our pieces pin it
+    Bitboard snipers = (bishopAttacks(mm.kingSq, 0) & (pos.pieces(xside, BISHOP) | pos.pieces(xside, QUEEN)))
+                     | (rookAttacks(mm.kingSq, 0) & (pos.pieces(xside, ROOK) | pos.pieces(xside, QUEEN)));
+    while (snipers) {
+        Bitboard blockers = betweenBB[mm.kingSq][popLsb(snipers)] & pos.occupied;
+        if (blockers && !moreThanOne(blockers)) mm.pinned |= blockers & pos.colorBB[side];
+    }
+    return mm;
+}
+
+// A pinned piece may only move along the line through its king and the pinner
+static inline bool pinAllows(const MoveMasks& mm, int from, int to) {
+    return !(mm.pinned & squareBB(from)) || (lineBB[mm.kingSq][from] & squareBB(to));
+}
+
+// Add a move from every square of `froms` shifted by `delta` to the matching square of `targets`.
+// Pawns reaching the last rank generate the four promotion moves instead.
+static void addPawnMoves(const Position& pos, const MoveMasks& mm, Bitboard targets, int delta, MoveList& Moves) {
+    targets &= mm.checkMask;
+    while (targets) {
+        int to = popLsb(targets);
+        int from = to - delta;
+        if (!pinAllows(mm, from, to)) continue;
+        if (ROW(to) == 0 || ROW(to) == 7) {
+            for (int k = KNIGHT; k <= QUEEN; ++k) {
+                // Provide the promotion piece and a high score for promotion moves
+                Moves.push_back(PackedMove(from, to, MOVE_PROMOTION | (k - KNIGHT)), 1000000 + (k * 10));
             }
+        } else if (pos.squares[to] != NO_PIECE) {
+            // If the move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
+            int score = 1000000 + (typeOf(pos.squares[to]) * 10) - PAWN;
+            Moves.push_back(PackedMove(from, to), score);
+        } else {
+            Moves.push_back(PackedMove(from, to));
         }
     }
+}
 
-    // Generate castling moves
-    if (board.canCastleK && board.whiteToMove) {
-        // White can castle kingside check all pieces are in the right place
-        if (board.pieces[F1] == '.' && board.pieces[G1] == '.' && 
-            board.pieces[E1] == 'K' && board.pieces[H1] == 'R') {
-                // Confirm King is not in check & none of the squares between the King & rook are attacked
-                if (!(attacked(board, E1, BLACK) || attacked(board, F1, BLACK) || attacked(board, G1, BLACK)))
-                    Moves.push_back({ROW(E1), COL(E1), ROW(G1), COL(G1), false, true}); // Kingside castling
+// Add a move from `from` to every square in `targets`
+static void addPieceMoves(const Position& pos, int from, Bitboard targets, MoveList& Moves) {
+    int attacker = typeOf(pos.squares[from]);
+    while (targets) {
+        int to = popLsb(targets);
+        if (pos.squares[to] != NO_PIECE) {
+            // Move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
+            int score = 1000000 + (typeOf(pos.squares[to]) * 10) - attacker;
+            Moves.push_back(PackedMove(from, to), score);
+        } else {
+            Moves.push_back(PackedMove(from, to)); // Add quiet move to empty square
         }
     }
-    if (board.canCastleQ && board.whiteToMove) {   
-        // White can castle queenside
-        if (board.pieces[D1] == '.' && board.pieces[C1] == '.' && 
-            board.pieces[B1] == '.' && board.pieces[E1] == 'K' && 
-            board.pieces[A1] == 'R') {
-                // Confirm King is not in check & none of the squares between the King & rook are attacked
-                if (!(attacked(board, E1, BLACK) || attacked(board, B1, BLACK) || attacked(board, C1, BLACK) || attacked(board, D1, BLACK)))
-                    Moves.push_back({ROW(E1), COL(E1), ROW(C1), COL(C1), false, true}); // Queenside castling
+}
+
+// Append the moves of kind genType (GEN_*) for the side to move to Moves.
+// With legal masks only legal moves are generated; otherwise they are pseudo legal.
+static void generate(const Position& pos, const MoveMasks& mm, MoveList& Moves, int genType) {
+    int side = pos.sideToMove();
+    int xside = side ^ 1;
+    Bitboard enemies = pos.colorBB[xside];
+    Bitboard empty = ~pos.occupied;
+    Bitboard targets = genType == GEN_CAPTURES ? enemies : genType == GEN_QUIETS ? empty : ~pos.colorBB[side];
+    Bitboard pawns = pos.pieces(side, PAWN);
+    Bitboard promotionRank = side == WHITE ? RANK_8_BB : RANK_1_BB;
+    if (mm.legal && mm.kingSq < 0) return;
+
+    // King moves. The king is taken off the board to test its destinations, so it
+    // cannot hide behind itself from a slider that checks it.
+    Bitboard king = pos.pieces(side, KING);
+    while (king) {
+        int from = popLsb(king);
+        Bitboard kingTargets = kingAttacks[from] & targets;
+        if (mm.legal) {
+            Bitboard b = kingTargets;
+            while (b) {
+                int to = popLsb(b);
+                if (pos.attackersTo(to, pos.occupied ^ squareBB(from)) & enemies) kingTargets &= ~squareBB(to);
+            }
         }
+        addPieceMoves(pos, from, kingTargets, Moves);
     }
-    if (board.canCastlek && !board.whiteToMove) {
-        // Black can castle kingside
-        if (board.pieces[F8] == '.' && board.pieces[G8] == '.' && 
-            board.pieces[E8] == 'k' && board.pieces[H8] == 'r') {
-                // Confirm King is not in check & none of the squares between the King & rook are attacked
-                if (!(attacked(board, E8, WHITE) || attacked(board, F8, WHITE) || attacked(board, G8, WHITE)))
-                    Moves.push_back({ROW(E8), COL(E8), ROW(G8), COL(G8), false, true}); // Kingside castling
+    // In double check only the king can move
+    if (mm.legal && moreThanOne(mm.checkers)) return;
+
+    // Pawns move as a set: shift all of them at once and then recover each from square.
+    // Promotions by a push count as captures, the other pushes are quiet moves.
+    Bitboard pushTargets = genType == GEN_CAPTURES ? promotionRank : genType == GEN_QUIETS ? ~promotionRank : ~0ULL;
+    if (side == WHITE) {
+        // White pawns move up the board in steps of -8 (or -16 if they are still on their starting rank)
+        Bitboard single = shiftNorth(pawns) & empty;
+        addPawnMoves(pos, mm, single & pushTargets, -8, Moves);
+        if (genType != GEN_CAPTURES)
+            addPawnMoves(pos, mm, shiftNorth(single & RANK_3_BB) & empty, -16, Moves);
+        if (genType != GEN_QUIETS) {
+            addPawnMoves(pos, mm, shiftNorth(shiftWest(pawns)) & enemies, -9, Moves);
+            addPawnMoves(pos, mm, shiftNorth(shiftEast(pawns)) & enemies, -7, Moves);
+        }
+    } else {
+        // Black pawns move down the board in steps of +8 (or +16 if they are still on their starting rank)
+        Bitboard single = shiftSouth(pawns) & empty;
+        addPawnMoves(pos, mm, single & pushTargets, 8, Moves);
+        if (genType != GEN_CAPTURES)
+            addPawnMoves(pos, mm, shiftSouth(single & RANK_6_BB) & empty, 16, Moves);
+        if (genType != GEN_QUIETS) {
+            addPawnMoves(pos, mm, shiftSouth(shiftWest(pawns)) & enemies, 7, Moves);
+            addPawnMoves(pos, mm, shiftSouth(shiftEast(pawns)) & enemies, 9, Moves);
         }
     }
-    if (board.canCastleq && !board.whiteToMove) {
-        // Black can castle queenside
-        if (board.pieces[D8] == '.' && board.pieces[C8] == '.' && 
-            board.pieces[B8] == '.' && board.pieces[E8] == 'k' && 
-            board.pieces[A8] == 'r') {
-                // Confirm King is not in check & none of the squares between the King & rook are attacked
-                if (!(attacked(board, E8, WHITE) || attacked(board, B8, BLACK) || attacked(board, C8, BLACK) || attacked(board, D8, BLACK)))
-                    Moves.push_back({ROW(E8), COL(E8), ROW(C8), COL(C8), false, true}); // Queenside castling
+
+    // Generate moves for the other pieces. Pinned knights can never move.
+    for (int pt = KNIGHT; pt <= QUEEN; ++pt) {
+        Bitboard b = pos.pieces(side, pt);
+        while (b) {
+            int from = popLsb(b);
+            Bitboard pieceTargets = pieceAttacks(pt, from, pos.occupied) & targets & mm.checkMask;
+            if (mm.pinned & squareBB(from)) pieceTargets &= lineBB[mm.kingSq][from];
+            addPieceMoves(pos, from, pieceTargets, Moves);
         }
     }
 
     // Generate en passant captures
-    if (board.enPassantTarget != -1) {
-        // std::cout << "generateMoves found EP target " << board.enPassantTarget << std::endl;
+    if (pos.enPassantTarget != -1 && genType != GEN_QUIETS) {
         // En passant captures are always pawn takes pawn so all have the same score
-        score = 1000000 + (PAWN * 10) - PAWN; // true, false, '\0', score
-        int targetRow = ROW(board.enPassantTarget);
-        int targetCol = COL(board.enPassantTarget);
-        // std::cout << "generateMoves board.whiteToMove " << board.whiteToMove << " targetRow " << targetRow << std::endl;
-        if (board.whiteToMove && targetRow == 2) {
-            // White can capture en passant if it has a pawn in the right place
-            // std::cout << "generateMoves board.pieces[board.enPassantTarget + 7] " << board.pieces[board.enPassantTarget + 7] << std::endl;
-            if (targetCol != 0 && board.pieces[board.enPassantTarget + 7] == 'P') {
-                // std::cout << "generateMoves found EP capture pawn for White " << board.enPassantTarget + 7 << std::endl;
-                Moves.push_back({targetRow + 1, targetCol - 1, targetRow, targetCol, true, false, '\0', score}); // Capture using pawn on left
-            }
-            // std::cout << "generateMoves board.pieces[board.enPassantTarget + 9] " << board.pieces[board.enPassantTarget + 9] << std::endl;
-            if (targetCol != 7 && board.pieces[board.enPassantTarget + 9] == 'P') {
-                // std::cout << "generateMoves found EP capture pawn for White " << board.enPassantTarget + 9 << std::endl;
-                Moves.push_back({targetRow + 1, targetCol + 1, targetRow, targetCol, true, false, '\0', score}); // Capture using pawn on right
-            }
-        } else if (board.whiteToMove == false && targetRow == 5) {
-            // Black can capture en passant
-            if (targetCol != 0 && board.pieces[board.enPassantTarget - 9] == 'p') {
-                // std::cout << "generateMoves found EP capture pawn for Black " << board.enPassantTarget - 9 << std::endl;
-                Moves.push_back({targetRow - 1, targetCol - 1, targetRow, targetCol, true, false, '\0', score}); // Capture using pawn on left
-            }
-            if (targetCol != 7 && board.pieces[board.enPassantTarget - 7] == 'p') {
-                // std::cout << "generateMoves found EP capture pawn for Black " << board.enPassantTarget - 7 << std::endl;
-                Moves.push_back({targetRow - 1, targetCol + 1, targetRow, targetCol, true, false, '\0', score}); // Capture using pawn on right
+        int score = 1000000 + (PAWN * 10) - PAWN;
+        int ep = pos.enPassantTarget;
+        int capturedSq = ep + (side == WHITE ? 8 : -8);
+        // Our pawns that could capture on ep are those a pawn of the other colour on ep would attack
+        Bitboard capturers = pawnAttacks[xside][ep] & pawns;
+        while (capturers) {
+            int from = popLsb(capturers);
+            // Two pawns leave the capturer's rank at once, which the pin masks cannot see,
+            // so test the king against the position after the capture
+            if (mm.legal) {
+                Bitboard occupied = (pos.occupied ^ squareBB(from) ^ squareBB(capturedSq)) | squareBB(ep);
+                if (pos.attackersTo(mm.kingSq, occupied) & enemies & ~squareBB(capturedSq)) continue;
             }
+            Moves.push_back(PackedMove(from, ep, MOVE_EN_PASSANT), score);
         }
     }
-    // Return the list of generated moves
+
+    if (genType == GEN_CAPTURES || mm.checkers) return;
+
+    // Generate castling moves.
+    // Confirm the King is not in check & none of the squares the King passes over are attacked.
+    if (side == WHITE) {
+        if ((pos.castling & CASTLE_WK) && pos.squares[E1] == makePiece(WHITE, KING) && pos.squares[H1] == makePiece(WHITE, ROOK)
+            && !(pos.occupied & (squareBB(F1) | squareBB(G1)))
+            && !(attacked(pos, E1, BLACK) || attacked(pos, F1, BLACK) || attacked(pos, G1, BLACK)))
+            Moves.push_back(PackedMove(E1, G1, MOVE_CASTLING)); // Kingside castling
+        if ((pos.castling & CASTLE_WQ) && pos.squares[E1] == makePiece(WHITE, KING) && pos.squares[A1] == makePiece(WHITE, ROOK)
+            && !(pos.occupied & (squareBB(B1) | squareBB(C1) | squareBB(D1)))
+            && !(attacked(pos, E1, BLACK) || attacked(pos, D1, BLACK) || attacked(pos, C1, BLACK)))
+            Moves.push_back(PackedMove(E1, C1, MOVE_CASTLING)); // Queenside castling
+    } else {
+        if ((pos.castling & CASTLE_BK) && pos.squares[E8] == makePiece(BLACK, KING) && pos.squares[H8] == makePiece(BLACK, ROOK)
+            && !(pos.occupied & (squareBB(F8) | squareBB(G8)))
+            && !(attacked(pos, E8, WHITE) || attacked(pos, F8, WHITE) || attacked(pos, G8, WHITE)))
+            Moves.push_back(PackedMove(E8, G8, MOVE_CASTLING)); // Kingside castling
+        if ((pos.castling & CASTLE_BQ) && pos.squares[E8] == makePiece(BLACK, KING) && pos.squares[A8] == makePiece(BLACK, ROOK)
+            && !(pos.occupied & (squareBB(B8) | squareBB(C8) | squareBB(D8)))
+            && !(attacked(pos, E8, WHITE) || attacked(pos, D8, WHITE) || attacked(pos, C8, WHITE)))
+            Moves.push_back(PackedMove(E8, C8, MOVE_CASTLING)); // Queenside castling
+    }
+}
+
+// Generate all pseudo legal moves for the current board state
+// Returns a MoveList containing all pseudo legal moves
+MoveList generatePseudoLegalMoves(const Position& pos) {
+    MoveList Moves;
+    generate(pos, MoveMasks{}, Moves, GEN_ALL);
     return Moves;
 }
 
-std::vector<Move> generateMoves(const BoardData& board) {
-    std::vector<Move> legalMoves;
-    std::vector<Move> pseudoMoves = generatePseudoLegalMoves(board);
-    int side = board.whiteToMove ? WHITE : BLACK;
-    for (const auto& m : pseudoMoves) {
-        BoardData next = applyMove(board, m);
-        if (!inCheck(next, side)) {
-            legalMoves.push_back(m);
-        }
+std::vector<Move> generatePseudoLegalMoves(const BoardData& board) {
+    return generatePseudoLegalMoves(Position(board)).toVector();
+}
+
+// Generate the legal moves. Checkers and pins are found once for the position, so no
+// move has to be played to test it.
+MoveList generateMoves(const Position& pos) {
+    MoveList Moves;
+    generate(pos, legalMasks(pos), Moves, GEN_ALL);
+    return Moves;
+}
+
+void generateMoves(const Position& pos, int genType, MoveList& Moves) {
+    generate(pos, legalMasks(pos), Moves, genType);
+}
+
+bool isLegalMove(const Position& pos, PackedMove m) {
+    // Checks a move that did not come from the generator, such as a transposition
+    // table move that may belong to another position with a colliding key
+    int side = pos.sideToMove();
+    int from = m.from();
+    int to = m.to();
+    int piece = pos.squares[from];
+    if (m.isNull() || piece == NO_PIECE || colorOf(piece) != side || pos.kingSquare(side) < 0)
+        return false;
+
+    // Castling and en passant are rare enough to look up among the generated moves
+    if (m.isCastling() || m.isEnPassant()) {
+        MoveList Moves;
+        generateMoves(pos, m.isCastling() ? GEN_QUIETS : GEN_CAPTURES, Moves);
+        return std::find(Moves.begin(), Moves.end(), m) != Moves.end();
     }
-    return legalMoves;
+
+    if (pos.colorBB[side] & squareBB(to)) return false;
+    int type = typeOf(piece);
+    if (type == PAWN) {
+        bool lastRank = ROW(to) == 0 || ROW(to) == 7;
+        int forward = side == WHITE ? -8 : 8;
+        bool capture = (pawnAttacks[side][from] & pos.colorBB[side ^ 1] & squareBB(to)) != 0;
+        bool push = to == from + forward && pos.squares[to] == NO_PIECE;
+        bool doublePush = to == from + 2 * forward && ROW(from) == (side == WHITE ? 6 : 1)
+                          && pos.squares[from + forward] == NO_PIECE && pos.squares[to] == NO_PIECE;
+        if (m.isPromotion() != lastRank || !(capture || push || doublePush)) return false;
+    } else if (m.isPromotion() || !(pieceAttacks(type, from, pos.occupied) & squareBB(to))) {
+        return false;
+    }
+
+    // The move is pseudo legal; apply the same tests as the legal generator
+    MoveMasks mm = legalMasks(pos);
+    if (type == KING)
+        return !(pos.attackersTo(to, pos.occupied ^ squareBB(from)) & pos.colorBB[side ^ 1]);
+    if (moreThanOne(mm.checkers)) return false;
+    return (mm.checkMask & squareBB(to)) && pinAllows(mm, from, to);
+}
+
+std::vector<Move> generateMoves(const BoardData& board) {
+    return generateMoves(Position(board)).toVector();
 }
 
 // Generate all pseudo legal capture and promote moves for the current position.
 // This function is used by the quiescence search.
+MoveList generatePseudoLegalCaptures(const Position& pos) {
+    MoveList Moves;
+    generate(pos, MoveMasks{}, Moves, GEN_CAPTURES);
+    return Moves;
+}
+
 std::vector<Move> generatePseudoLegalCaptures(const BoardData& board) {
-    std::vector<Move> Moves;
-    int i, j, n;
-    int side, xside;
-    int score = 0;
-    char p;
-
-    if (board.whiteToMove) { side = WHITE; xside = BLACK; }
-    else { side = BLACK; xside = WHITE; }
-    
-    for (i = 0; i < 64; ++i) {
-        if (board.PieceColor(i) == side) {
-            // If the colour of the piece on square i matches the side to move
-            if (board.PieceType(i) == PAWN) {
-                // Generate pawn moves
-                if (side == WHITE) {
-                    // White pawns move up the board in steps of -8 (or -16 if they are still on their starting rank)
-                    // White pawns start on rank 2 (row 6) squares 48 to 55
-                    if (COL(i) != 0 && board.PieceColor(i - 9) == BLACK) {
-                        // White pawn making a capture
-                        if (ROW(i - 9) == 0) {
-                            // White pawn moving to last rank so generate promotion moves
-                            for (int k = KNIGHT; k <= QUEEN; ++k) {
-                                // The promotion is a capture so provide the promotion piece and a high score for promotion moves.
-                                score = (1000000 + (k * 10));
-                                Moves.push_back({ROW(i), COL(i), ROW(i - 9), COL(i - 9), false, false, TYPEtoCHAR(k), score});
-                            }
-                        } else {
-                            // The move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                            score = (1000000 + (board.PieceType(i - 9) * 10) - board.PieceType(i));
-                            Moves.push_back({ROW(i), COL(i), ROW(i - 9), COL(i - 9), false, false, '\0', score});
-                        }
-                    }
-                    if (COL(i) != 7 && board.PieceColor(i - 7) == BLACK) {
-                        // White pawn making a capture
-                        if (ROW(i - 7) == 0) {
-                            // White pawn moving to last rank so generate promotion moves
-                            for (int k = KNIGHT; k <= QUEEN; ++k) {
-                                score = (1000000 + (k * 10));
-                                // The promotion is a capture so provide the promotion piece and a high score for promotion moves
-                                Moves.push_back({ROW(i), COL(i), ROW(i - 7), COL(i - 7), false, false, TYPEtoCHAR(k), score});
-                            }
-                        } else {
-                            // If the move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                            score = (1000000 + (board.PieceType(i - 7) * 10) - board.PieceType(i));
-                            Moves.push_back({ROW(i), COL(i), ROW(i - 7), COL(i - 7), false, false, '\0', score});
-                        }
-                    }
-                } else { // Black pawns move down the board in steps of +8 (or +16 if they are still on their starting rank)
-                    // Black pawns start on rank 7 (row 1) squares 8 to 15
-                    if (COL(i) != 0 && board.PieceColor(i + 7) == WHITE) {
-                        // Black pawn making a capture
-                        if (ROW(i + 7) == 7) {
-                            // Black pawn moving to last rank so generate promotion moves
-                            for (int k = KNIGHT; k <= QUEEN; ++k) {
-                                // The promotion is a capture so provide the promotion piece and a high score for promotion moves
-                                score = (1000000 + (k * 10));
-                                Moves.push_back({ROW(i), COL(i), ROW(i + 7), COL(i + 7), false, false, TYPEtoCHAR(k), score});
-                            }
-                        } else {
-                            // If the move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                            score = (1000000 + (board.PieceType(i + 7) * 10) - board.PieceType(i));
-                            Moves.push_back({ROW(i), COL(i), ROW(i + 7), COL(i + 7), false, false, '\0', score});
-                        }
-                    }
-                    if (COL(i) != 7 && board.PieceColor(i + 9) == WHITE) {
-                        // Black pawn making a capture
-                        if (ROW(i + 9) == 7) {
-                            // Black pawn moving to last rank so generate promotion moves
-                            for (int k = KNIGHT; k <= QUEEN; ++k) {
-                                // Provide the promotion piece and a high score for promotion moves
-                                score = (1000000 + (k * 10));
-                                Moves.push_back({ROW(i), COL(i), ROW(i + 9), COL(i + 9), false, false, TYPEtoCHAR(k), (1000000 + (k * 10))});
-                            }
-                        } else {
-                            // If the move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                            score = (1000000 + (board.PieceType(i + 9) * 10) - board.PieceType(i));
-                            Moves.push_back({ROW(i), COL(i), ROW(i + 9), COL(i + 9), false, false, '\0', score});
-                        }
-                    }
-                }
-            } else {// Generate moves for other piece types
-                switch (board.PieceType(i)) {
-                    case KNIGHT: // Knight moves
-                        for (j = 0; j < 8; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + knightOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (board.PieceColor(n) != EMPTY) {
-                                    if (board.PieceColor(n) == xside) {
-                                        // Move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                                        score = (1000000 + (board.PieceType(n) * 10) - board.PieceType(i));
-                                        Moves.push_back({ROW(i), COL(i), ROW(n), COL(n), false, false, '\0', score});
-                                    }
-                                    break; // Stop at enemy piece
-                                }
-                                // This piece does not slide (e.g. king or knight), so stop after one move in any direction
-                                break;
-                            }
-                        }
-                        break;
-                    case BISHOP: // Bishop moves
-                        for (j = 0; j < 4; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + bishopOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (board.PieceColor(n) != EMPTY) {
-                                    if (board.PieceColor(n) == xside) {
-                                        // Move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                                        score = (1000000 + (board.PieceType(n) * 10) - board.PieceType(i));
-                                        Moves.push_back({ROW(i), COL(i), ROW(n), COL(n), false, false, '\0', score});
-                                    }
-                                    break; // Stop at enemy piece
-                                }
-                            }
-                        }
-                        break;
-                    case ROOK: // Rook moves
-                        for (j = 0; j < 4; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + rookOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (board.PieceColor(n) != EMPTY) {
-                                    if (board.PieceColor(n) == xside) {
-                                        // Move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                                        score = (1000000 + (board.PieceType(n) * 10) - board.PieceType(i));
-                                        Moves.push_back({ROW(i), COL(i), ROW(n), COL(n), false, false, '\0', score});
-                                    }
-                                    break; // Stop at enemy piece
-                                }
-                            }
-                        }
-                        break;
-                    case QUEEN: // Queen moves
-                        for (j = 0; j < 8; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + queenOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (board.PieceColor(n) != EMPTY) {
-                                    if (board.PieceColor(n) == xside) {
-                                        // Move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                                        score = (1000000 + (board.PieceType(n) * 10) - board.PieceType(i));
-                                        Moves.push_back({ROW(i), COL(i), ROW(n), COL(n), false, false, '\0', score});
-                                    }
-                                    break; // Stop at enemy piece
-                                }    
-                            }
-                        }
-                        break;
-                    case KING: // King moves
-                        for (j = 0; j < 8; ++j) {
-                            n = i;
-                            while (true) {
-                                n = mailbox[mailbox64[n] + kingOffsets[j]]; // Add the mailbox offset to get target square
-                                if (n == -1) break; // Stop at invalid squares
-                                if (board.PieceColor(n) != EMPTY) {
-                                    if (board.PieceColor(n) == xside) {
-                                        // Move is a capture, calculate score using MVV/LVA (Most Valuable Victim/Least Valuable Attacker).
-                                        score = (1000000 + (board.PieceType(n) * 10) - board.PieceType(i));
-                                        Moves.push_back({ROW(i), COL(i), ROW(n), COL(n), false, false, '\0', score});
-                                    }
-                                    break; // Stop at enemy piece
-                                }    
-                                // This piece does not slide (e.g. king or knight), so stop after one move in any direction
-                                break;
-                            }
-                        }
-                        break;
-                    default:
-                    // Invalid piece type, do nothing
-                    break;   
-                }
-            }
-        }
-    }
+    return generatePseudoLegalCaptures(Position(board)).toVector();
+}
 
-    // Generate en passant captures
-    if (board.enPassantTarget != -1) {
-        // std::cout << "generateMoves found EP target " << board.enPassantTarget << std::endl;
-        // En passant captures are always pawn takes pawn so all have the same score
-        score = 1000000 + (PAWN * 10) - PAWN; // true, false, '\0', score
-        int targetRow = ROW(board.enPassantTarget);
-        int targetCol = COL(board.enPassantTarget);
-        // std::cout << "generateMoves board.whiteToMove " << board.whiteToMove << " targetRow " << targetRow << std::endl;
-        if (board.whiteToMove && targetRow == 2) {
-            // White can capture en passant if it has a pawn in the right place
-            // std::cout << "generateMoves board.pieces[board.enPassantTarget + 7] " << board.pieces[board.enPassantTarget + 7] << std::endl;
-            if (targetCol != 0 && board.pieces[board.enPassantTarget + 7] == 'P') {
-                // std::cout << "generateMoves found EP capture pawn for White " << board.enPassantTarget + 7 << std::endl;
-                Moves.push_back({targetRow + 1, targetCol - 1, targetRow, targetCol, true, false, '\0', score}); // Capture using pawn on left
-            }
-            // std::cout << "generateMoves board.pieces[board.enPassantTarget + 9] " << board.pieces[board.enPassantTarget + 9] << std::endl;
-            if (targetCol != 7 && board.pieces[board.enPassantTarget + 9] == 'P') {
-                // std::cout << "generateMoves found EP capture pawn for White " << board.enPassantTarget + 9 << std::endl;
-                Moves.push_back({targetRow + 1, targetCol + 1, targetRow, targetCol, true, false, '\0', score}); // Capture using pawn on right
-            }
-        } else if (board.whiteToMove == false && targetRow == 5) {
-            // Black can capture en passant
-            if (targetCol != 0 && board.pieces[board.enPassantTarget - 9] == 'p') {
-                // std::cout << "generateMoves found EP capture pawn for Black " << board.enPassantTarget - 9 << std::endl;
-                Moves.push_back({targetRow - 1, targetCol - 1, targetRow, targetCol, true, false, '\0', score}); // Capture using pawn on left
-            }
-            if (targetCol != 7 && board.pieces[board.enPassantTarget - 7] == 'p') {
-                // std::cout << "generateMoves found EP capture pawn for Black " << board.enPassantTarget - 7 << std::endl;
-                Moves.push_back({targetRow - 1, targetCol + 1, targetRow, targetCol, true, false, '\0', score}); // Capture using pawn on right
-            }
-        }
-    }
-    // Return the list of generated moves
+MoveList generateCaptures(const Position& pos) {
+    MoveList Moves;
+    generate(pos, legalMasks(pos), Moves, GEN_CAPTURES);
     return Moves;
 }
 
 std::vector<Move> generateCaptures(const BoardData& board) {
-    std::vector<Move> legalMoves;
-    std::vector<Move> pseudoMoves = generatePseudoLegalCaptures(board);
-    int side = board.whiteToMove ? WHITE : BLACK;
-    for (const auto& m : pseudoMoves) {
-        BoardData next = applyMove(board, m);
-        if (!inCheck(next, side)) {
-            legalMoves.push_back(m);
-        }
-    }
-    return legalMoves;
+    return generateCaptures(Position(board)).toVector();
 }
 
 std::vector<Move> sortMoves(std::vector<Move>& moves, const BoardData& board) {
@@ -1034,7 +712,7 @@ std::vector<Move> sortMoves(std::vector<Move>& moves, const BoardData& board) {
 int old_quiescence(BoardData board, int alpha, int beta, bool maximizing,
                std::chrono::steady_clock::time_point deadline, std::atomic<bool>& stop) {
     // Quiescence search is a search that continues until a stable position is reached.
-    g_nodes.fetch_add(1, std::memory_order_relaxed);          // <-- count this node
+    g_ctx.stats.addQNode();
     if (stop.load() || std::chrono::steady_clock::now() > deadline) return 0;
 
     int stand_pat = evaluate(board);
@@ -1063,84 +741,119 @@ int old_quiescence(BoardData board, int alpha, int beta, bool maximizing,
 }
 
 // ----------------------- Helpers --------------------------------------------
-static inline int stmSign(const BoardData& b) { return b.whiteToMove ? +1 : -1; }
+static inline int stmSign(const Position& b) { return b.whiteToMove ? +1 : -1; }
 
-static inline bool isCaptureMove(const BoardData& b, const Move& m) {
-    // Basic capture detection: piece present on destination before the move
-    // (En passant not covered unless your Move carries that flag; extend if needed.)
-    int to = m.toRow * 8 + m.toCol;
-    char dst = b.pieces[to];
-    if (dst != '.') return true;
+static inline bool isCaptureMove(const Position& b, PackedMove m) {
+    // A piece on the destination before the move, or an en passant capture
+    return b.squares[m.to()] != NO_PIECE || m.isEnPassant();
+}
+
+// The search reads the clock only once every TIME_CHECK_NODES nodes of a thread. A
+// driver with a DeadlineTimer (timeman.h) has the stop flag set for it at the deadline;
+// the clock check is the fallback for callers that only pass a deadline.
+#define TIME_CHECK_NODES    1024
 
-    // If you have flags on Move, uncomment/extend:
-    // if (m.isEnPassant) return true;
+static thread_local int timeCheckCountdown = TIME_CHECK_NODES;
 
-    return false;
+// Called once per node: true if the search must unwind. Sets stop when the deadline has
+// passed, so once this is true every later test of the flag agrees.
+static inline bool searchAborted(std::atomic<bool>& stop, std::chrono::steady_clock::time_point deadline) {
+    if (--timeCheckCountdown <= 0) {
+        timeCheckCountdown = TIME_CHECK_NODES;
+        if (std::chrono::steady_clock::now() > deadline) stop.store(true, std::memory_order_relaxed);
+    }
+    return stop.load(std::memory_order_relaxed);
 }
 
+static inline bool stopped(const std::atomic<bool>& stop) {
+    return stop.load(std::memory_order_relaxed);
+}
+
+// Swap the highest scoring of moves[i..] into moves[i]. Picking one move at a time
+// sorts only as far as the search gets before a cutoff.
+static inline void pickNext(MoveList& moves, int i) {
+    int best = i;
+    for (int j = i + 1; j < moves.size(); ++j)
+        if (moves.score(j) > moves.score(best)) best = j;
+    if (best != i) {
+        std::swap(moves[i], moves[best]);
+        std::swap(moves.score(i), moves.score(best));
+    }
+}
+
+
 // ----------------------- Quiescence (negamax, captures only) -----------------
-int quiescenceTimed(BoardData& board, int alpha, int beta, int qdepth,
-                    std::chrono::steady_clock::time_point deadline,
-                    std::atomic<bool>& stop, std::vector<Move>& pv)
+// Delta pruning: a capture is skipped when even winning the victim plus this margin
+// would leave the score at or below alpha
+#define DELTA_MARGIN    200
+
+// The line from the node at ply in the calling thread's PV table, for the interfaces
+// that hand out a std::vector<Move>
+static void copyPV(int ply, std::vector<Move>& pv) {
+    const PVTable& t = *g_ctx.pvTable;
+    pv.clear();
+    for (int i = 0; i < t.size(ply); ++i) pv.push_back(unpackMove(t.line(ply)[i]));
+}
+
+// The PV of the node goes to row board.ply of the thread's PV table
+static int qsearch(Position& board, int alpha, int beta, int qdepth,
+                   std::chrono::steady_clock::time_point deadline, std::atomic<bool>& stop)
 {
-    if (stop.load() || std::chrono::steady_clock::now() > deadline) {
-        pv.clear();
-        return 0;
-    }
-    g_nodes.fetch_add(1, std::memory_order_relaxed);
+    g_ctx.pvTable->clear(board.ply);
+    if (searchAborted(stop, deadline)) return 0;
+    g_ctx.stats.addQNode();
 
     // Stand-pat (static) eval from STM perspective
     int standPat = stmSign(board) * evaluate(board);
 
     // Fail-high
-    if (standPat >= beta) {
-        pv.clear();
-        return standPat;
-    }
+    if (standPat >= beta) return standPat;
+
+    // Not even winning a queen would reach alpha, so no capture can
+    if (g_selectiveSearch && standPat + piece_value[QUEEN] + DELTA_MARGIN <= alpha) return standPat;
 
     // Raise alpha
     if (standPat > alpha) alpha = standPat;
 
     // Depth safety for pathological capture trees
-    if (qdepth <= 0) {
-        pv.clear();
-        return standPat;
-    }
+    if (qdepth <= 0) return standPat;
 
-    // Generate *captures only*
-    std::vector<Move> moves = generateMoves(board);
-    // Filter to captures; if you already have generateCaptures(), use that instead.
-    std::vector<Move> caps;
-    caps.reserve(moves.size());
-    for (const auto& m : moves) {
-        if (isCaptureMove(board, m)) caps.push_back(m);
-    }
+    // Captures and promotions only. They are pseudo legal: most are never searched
+    // because of a cutoff, so legality is only tested for the ones that are.
+    MoveList caps = generatePseudoLegalCaptures(board);
 
-    if (caps.empty()) {
-        pv.clear();
-        return standPat;
-    }
+    int bestScore = standPat; // A capture is only in the PV if it beats standing pat
+    int side = board.sideToMove();
 
-    int bestScore = standPat; // not strictly required, but useful for PV logic
-    Move bestMove{};
-    std::vector<Move> bestLine;
+    for (int i = 0; i < caps.size(); ++i) {
+        if (stopped(stop)) break;
 
-    // (Optional) order captures (MVV-LVA etc.) for better pruning
-    // std::sort(caps.begin(), caps.end(), [&](const Move& a, const Move& b) { ... });
+        // Most valuable victim first, taken by the least valuable attacker
+        pickNext(caps, i);
+        PackedMove m = caps[i];
 
-    for (const auto& m : caps) {
-        if (stop.load() || std::chrono::steady_clock::now() > deadline) break;
+        // Promotions are never delta pruned, they gain more than the victim
+        if (!m.isPromotion()) {
+            int victim = m.isEnPassant() ? PAWN : typeOf(board.squares[m.to()]);
+            if (g_selectiveSearch && standPat + piece_value[victim] + DELTA_MARGIN <= alpha) continue;
+        }
 
-        BoardData child = applyMove(board, m);
-        std::vector<Move> childPV;
+        // Standing pat does better than a capture that loses material in the exchange
+        if (losingCapture(board, m)) continue;
+
+        board.makeMove(m);
+        if (inCheck(board, side)) {
+            board.unmakeMove(m);
+            continue;
+        }
 
         // Negamax recurse on captures only: flip window, negate result
-        int score = -quiescenceTimed(child, -beta, -alpha, qdepth - 1, deadline, stop, childPV);
+        int score = -qsearch(board, -beta, -alpha, qdepth - 1, deadline, stop);
+        board.unmakeMove(m);
 
         if (score > bestScore) {
             bestScore = score;
-            bestMove  = m;
-            bestLine  = std::move(childPV);
+            g_ctx.pvTable->update(board.ply, m);
         }
 
         if (bestScore > alpha) alpha = bestScore;
@@ -1148,81 +861,383 @@ int quiescenceTimed(BoardData& board, int alpha, int beta, int qdepth,
             break; // cutoff
         }
     }
+    return bestScore;
+}
 
-    // Build PV for quiescence (optional but handy for debugging)
-    pv.clear();
-    if (!(bestMove.fromRow==0 && bestMove.fromCol==0 && bestMove.toRow==0 && bestMove.toCol==0)
-        && bestScore > standPat) {
-        pv.push_back(bestMove);
-        pv.insert(pv.end(), bestLine.begin(), bestLine.end());
+int quiescenceTimed(Position& board, int alpha, int beta, int qdepth,
+                    std::chrono::steady_clock::time_point deadline,
+                    std::atomic<bool>& stop, std::vector<Move>& pv)
+{
+    int score = qsearch(board, alpha, beta, qdepth, deadline, stop);
+    copyPV(board.ply, pv);
+    return score;
+}
+
+int quiescenceTimed(BoardData& board, int alpha, int beta, int qdepth,
+                    std::chrono::steady_clock::time_point deadline,
+                    std::atomic<bool>& stop, std::vector<Move>& pv)
+{
+    Position pos(board);
+    return quiescenceTimed(pos, alpha, beta, qdepth, deadline, stop, pv);
+}
+
+// ─── Internal: Young Brothers Wait split points ──────────────────────────────
+// Nodes at least this deep may hand their younger brothers to the thread pool
+#define YBWC_MIN_SPLIT_DEPTH    3
+
+static int negamaxTimed(Position& board, int depth, int alpha, int beta,
+                        std::chrono::steady_clock::time_point deadline,
+                        std::atomic<bool>& stop, ThreadPool* pool = nullptr, bool allowNull = true);
+
+// Late Move Reductions: quiet moves that come late in the ordering rarely raise alpha,
+// so they are searched less deeply, by reductionTable[depth][moveNumber] plies
+#define LMR_MIN_DEPTH   3
+#define LMR_MIN_MOVES   4   // The first moves of a node are never reduced
+
+namespace {
+    int reductionTable[64][64];
+
+    struct ReductionInit {
+        ReductionInit() {
+            for (int d = 0; d < 64; ++d)
+                for (int n = 0; n < 64; ++n)
+                    reductionTable[d][n] = (d == 0 || n == 0)
+                        ? 0 : (int)(0.75 + std::log(d) * std::log(n) / 2.25);
+        }
+    } reductionInit;
+}
+
+// Plies to take off the search of m, the moveNumber-th move (from 1) of a node at
+// depth. Captures, promotions, killers and every move of a node in check get the full
+// depth; searchChild also drops the reduction for a move that gives check.
+static int lateMoveReduction(const Position& pos, PackedMove m, int depth, int moveNumber, bool checked) {
+    if (!g_selectiveSearch || checked || depth < LMR_MIN_DEPTH || moveNumber < LMR_MIN_MOVES) return 0;
+    if (isCaptureMove(pos, m) || m.isPromotion()) return 0;
+    int ply = std::min(pos.ply, KillerTable::MAX_PLY - 1);
+    if (m == g_ctx.killers.k1[ply] || m == g_ctx.killers.k2[ply]) return 0;
+    // Leave at least one ply to search
+    return std::min(reductionTable[std::min(depth, 63)][std::min(moveNumber, 63)], depth - 2);
+}
+
+// Play m on pos, search the child and take m back; returns the score from the mover's
+// side. Principal Variation Search: the first move of a node gets the full window, the
+// others a null window that only shows whether they beat alpha, and just those that do
+// are searched again with the full window to get their score. A move searched with a
+// reduction that beats alpha is first searched again at full depth with the null window.
+// The child's line is left in the PV table row one ply below pos.
+static int searchChild(Position& pos, PackedMove m, int depth, int alpha, int beta, bool firstMove,
+                       int reduction, std::chrono::steady_clock::time_point deadline,
+                       std::atomic<bool>& stop, ThreadPool* pool)
+{
+    pos.makeMove(m);
+    int score;
+    if (firstMove) {
+        score = -negamaxTimed(pos, depth - 1, -beta, -alpha, deadline, stop, pool);
+    } else {
+        if (reduction > 0 && inCheck(pos, pos.sideToMove())) reduction = 0;
+        score = -negamaxTimed(pos, depth - 1 - reduction, -alpha - 1, -alpha, deadline, stop, pool);
+        if (reduction > 0 && score > alpha)
+            score = -negamaxTimed(pos, depth - 1, -alpha - 1, -alpha, deadline, stop, pool);
+        if (score > alpha && score < beta)
+            score = -negamaxTimed(pos, depth - 1, -beta, -alpha, deadline, stop, pool);
     }
-    return bestScore;
+    pos.unmakeMove(m);
+    return score;
+}
+
+namespace {
+    // A node whose remaining moves are being searched in parallel
+    struct SplitPoint {
+        std::mutex mu;              // Guards alpha and the best result
+        int alpha, beta;
+        int bestScore;
+        PackedMove bestMove;
+        bool improved = false;              // A task found a new best move,
+        PackedMove line[PVTable::MAX_PLY];  // whose continuation this is
+        int lineLength = 0;
+        PackedMove quiets[64];              // Quiet moves searched without a cutoff
+        int quietCount = 0;
+        std::atomic<int> pending{0};        // Moves not finished yet
+        std::atomic<bool> cutoff{false};    // Set on a beta cutoff, unstarted moves are skipped
+    };
+}
+
+// Search the remaining moves of a node in parallel once its first move, the eldest
+// brother, has been searched without a cutoff. Each move is a pool task on its own copy of the position,
+// searched with the best alpha known when it starts. The calling thread runs queued
+// tasks until all of them are done, then the node's alpha, best result and PV are updated.
+// Tasks search with a PV table of their own and pass a new best line back through sp.
+// The quiet moves searched without a cutoff are appended to quiets, for the history malus.
+static void searchSplitPoint(const Position& pos, const MoveList& moves, int depth,
+                             int& alpha, int beta,
+                             std::chrono::steady_clock::time_point deadline,
+                             std::atomic<bool>& stop, ThreadPool* pool,
+                             int& bestScore, PackedMove& bestMove,
+                             PackedMove* quiets, int& quietCount)
+{
+    SplitPoint sp;
+    sp.alpha = alpha;
+    sp.beta = beta;
+    sp.bestScore = bestScore;
+    sp.bestMove = bestMove;
+    sp.pending = (int)moves.size();
+    bool checked = inCheck(pos, pos.sideToMove());
+
+    for (int i = 0; i < moves.size(); ++i) {
+        // The eldest brother was move 1, so moves[i] is move i + 2 of the node
+        int reduction = lateMoveReduction(pos, moves[i], depth, i + 2, checked);
+        pool->submit([&sp, &stop, child = pos, m = moves[i], depth, reduction, deadline, pool]() mutable {
+            if (!sp.cutoff.load() && !stopped(stop)) {
+                g_ctx.prepareSearch();
+                int a;
+                {
+                    std::lock_guard<std::mutex> lk(sp.mu);
+                    a = sp.alpha;
+                }
+                g_ctx.enterTask();
+                bool quiet = !isCaptureMove(child, m) && !m.isPromotion();
+                int score = searchChild(child, m, depth, a, sp.beta, false, reduction, deadline, stop, pool);
+
+                std::lock_guard<std::mutex> lk(sp.mu);
+                if (score > sp.bestScore) {
+                    const PVTable& t = *g_ctx.pvTable;
+                    sp.bestScore = score;
+                    sp.bestMove  = m;
+                    sp.improved  = true;
+                    sp.lineLength = t.size(child.ply + 1);
+                    if (sp.lineLength > 0)
+                        std::copy(t.line(child.ply + 1), t.line(child.ply + 1) + sp.lineLength, sp.line);
+                }
+                if (sp.bestScore > sp.alpha) sp.alpha = sp.bestScore;
+                if (sp.alpha >= sp.beta) sp.cutoff = true;
+                if (quiet && score < sp.beta && sp.quietCount < 64)
+                    sp.quiets[sp.quietCount++] = m;
+                g_ctx.leaveTask();
+            }
+            sp.pending--;
+        });
+    }
+    pool->helpUntil([&sp] { return sp.pending.load() == 0; });
+
+    alpha = sp.alpha;
+    bestScore = sp.bestScore;
+    bestMove = sp.bestMove;
+    if (sp.improved) g_ctx.pvTable->update(pos.ply, bestMove, sp.line, sp.lineLength);
+    for (int i = 0; i < sp.quietCount && quietCount < 64; ++i)
+        quiets[quietCount++] = sp.quiets[i];
+}
+
+// Bonus or malus for quiet move m in the history and the continuation history of the
+// moves one and two plies back
+static void updateQuietHistory(const Position& pos, PackedMove m, int bonus) {
+    int piece = pos.squares[m.from()];
+    g_ctx.history.update(pos.sideToMove(), m.from(), m.to(), bonus);
+    for (int back = 1; back <= 2; ++back)
+        if (pos.playedPiece(back) != NO_PIECE)
+            g_ctx.contHistory.update(pos.playedPiece(back), pos.playedMove(back).to(), piece, m.to(), bonus);
+}
+
+// A quiet move caused a beta cutoff: make it a killer for this ply and the counter to
+// the opponent's last move, and reward it in the history tables at the expense of the
+// quiet moves searched before it
+static void updateQuietStats(const Position& pos, PackedMove best, int depth,
+                             const PackedMove* quiets, int quietCount)
+{
+    int bonus = std::min(depth * depth, 400);
+    g_ctx.killers.add(std::min(pos.ply, KillerTable::MAX_PLY - 1), best);
+    if (pos.playedPiece(1) != NO_PIECE)
+        g_ctx.counters.m[pos.playedPiece(1)][pos.playedMove(1).to()] = best;
+    updateQuietHistory(pos, best, bonus);
+    for (int i = 0; i < quietCount; ++i)
+        updateQuietHistory(pos, quiets[i], -bonus);
+}
+
+// Null-move pruning: passing the turn and still failing high on a reduced search means
+// the node would almost surely fail high too. From NULL_MOVE_VERIFY_DEPTH on, such a
+// cutoff is only taken once a reduced search of the node itself, without a null move,
+// confirms it, which catches zugzwang positions the material test lets through.
+#define NULL_MOVE_MIN_DEPTH     3
+#define NULL_MOVE_REDUCTION     3   // Plus one ply for every 6 of depth
+#define NULL_MOVE_VERIFY_DEPTH  8
+
+// Frontier pruning on the static eval, at null-window nodes of depth 1 to 3:
+//   razoring:         eval + RAZOR_MARGIN*depth is below alpha, so if a quiescence search
+//                     cannot lift the score either, return it
+//   reverse futility: eval - RFP_MARGIN*depth still beats beta, so return the eval
+//   futility:         eval + FUTILITY_MARGIN*depth does not reach alpha, so quiet moves
+//                     that do not give check are skipped once one move has been searched
+#define FRONTIER_MAX_DEPTH  3
+#define RAZOR_MARGIN        250
+#define RFP_MARGIN          80
+#define FUTILITY_MARGIN     100
+
+// Make m to see whether it checks the opponent's king
+static bool givesCheck(Position& pos, PackedMove m) {
+    pos.makeMove(m);
+    bool check = inCheck(pos, pos.sideToMove());
+    pos.unmakeMove(m);
+    return check;
+}
+
+// True if side has a piece other than pawns and its king, so passing is unlikely to be
+// its best move (zugzwang is mostly a pawn endgame affair)
+static inline bool hasNonPawnMaterial(const Position& pos, int side) {
+    return (pos.colorBB[side] & ~pos.pieces(side, PAWN) & ~pos.pieces(side, KING)) != 0;
 }
 
 // ─── Internal: Negamax core with PV (timed) ──────────────────────────────────
 // Returns score from the *current side-to-move's* perspective.
 // alpha/beta are also from current side’s perspective (negamax convention).
-static int negamaxTimed(BoardData& board, int depth, int alpha, int beta,
+// With a pool, nodes may split their younger brothers over its threads (YBWC).
+// allowNull is false for a null-move verification search, which must not pass again.
+// The PV is left in row board.ply of the thread's PV table.
+static int negamaxTimed(Position& board, int depth, int alpha, int beta,
                         std::chrono::steady_clock::time_point deadline,
-                        std::atomic<bool>& stop, std::vector<Move>& pv)
+                        std::atomic<bool>& stop, ThreadPool* pool, bool allowNull)
 {
-    if (stop.load() || std::chrono::steady_clock::now() > deadline) {
-        pv.clear();
-        return 0;
-    }
-    g_nodes.fetch_add(1, std::memory_order_relaxed);
+    PVTable& pvt = *g_ctx.pvTable;
+    pvt.clear(board.ply);
+    if (searchAborted(stop, deadline)) return 0;
+    g_ctx.stats.addNode();
 
-    // 50-move rule draw
-    if (board.halfmoveClock >= 100) {
-        pv.clear();
-        return 0;
-    }
+    // 50-move rule draw, or a repetition of a position earlier in the line
+    if (board.halfmoveClock >= 100 || board.isRepetition()) return 0;
 
     if (depth == 0) {
         // Switch to quiescence at the leaf
-        return quiescenceTimed(board, alpha, beta, /*qdepth=*/8, deadline, stop, pv);
+        return qsearch(board, alpha, beta, /*qdepth=*/8, deadline, stop);
     }
 
-    auto moves = generateMoves(board);
-    if (moves.empty()) {
-        // No legal moves: you can add mate/stalemate detection here to return mate scores.
-        int s = stmSign(board) * evaluate(board);
-        pv.clear();
-        return s;
+    // Transposition table: a deep enough entry whose bound already decides this window
+    // ends the node. The root (ply 0) always searches so it returns a full PV.
+    TTEntry tte;
+    bool ttHit = g_tt.probe(board.key, tte);
+    if (ttHit) g_ctx.stats.addTTHit();
+    if (ttHit && board.ply > 0 && tte.depth >= depth) {
+        if (tte.flag == TT_EXACT
+            || (tte.flag == TT_BETA && tte.score >= beta)
+            || (tte.flag == TT_ALPHA && tte.score <= alpha)) {
+            return tte.score;
+        }
     }
 
-    int bestScore = -INF;
-    Move bestMove{};
-    std::vector<Move> bestLine;
+    // Forward pruning is only done at null-window nodes, and never in check
+    bool checked = inCheck(board, board.sideToMove());
+    bool prunable = g_selectiveSearch && beta == alpha + 1 && !checked && board.ply > 0;
+    int staticEval = prunable ? stmSign(board) * evaluate(board) : 0;
 
-    // (Optional) move ordering here: captures first, killers/history/TT
+    if (prunable && depth <= FRONTIER_MAX_DEPTH) {
+        if (staticEval + RAZOR_MARGIN * depth < alpha) {
+            int score = qsearch(board, alpha, beta, /*qdepth=*/8, deadline, stop);
+            if (score <= alpha) return score;
+        }
+        if (staticEval - RFP_MARGIN * depth >= beta) {
+            pvt.clear(board.ply);
+            return staticEval;
+        }
+    }
+    int futilityValue = staticEval + FUTILITY_MARGIN * depth;
+    bool futile = prunable && depth <= FRONTIER_MAX_DEPTH && futilityValue <= alpha;
+
+    // Null move, never twice in a row
+    if (prunable && allowNull && depth >= NULL_MOVE_MIN_DEPTH
+        && !board.playedMove(1).isNull()
+        && hasNonPawnMaterial(board, board.sideToMove())
+        && staticEval >= beta)
+    {
+        int R = NULL_MOVE_REDUCTION + depth / 6;
+        int nullDepth = std::max(depth - 1 - R, 0);
+        board.makeNullMove();
+        int score = -negamaxTimed(board, nullDepth, -beta, -beta + 1, deadline, stop, pool);
+        board.unmakeNullMove();
+
+        if (score >= beta && !stopped(stop)) {
+            if (depth < NULL_MOVE_VERIFY_DEPTH
+                || negamaxTimed(board, std::max(depth - R, 1), beta - 1, beta, deadline, stop,
+                                pool, false) >= beta)
+            {
+                pvt.clear(board.ply);
+                return score;
+            }
+        }
+    }
 
-    for (const auto& m : moves) {
-        BoardData child = applyMove(board, m);
+    // Razoring or a verification search may have filled this node's row
+    pvt.clear(board.ply);
+
+    // Moves are produced in stages, starting with the stored best move, so a cut
+    // node often never generates its quiet moves
+    MovePicker picker(board, ttHit ? tte.best : PackedMove{});
+
+    const int alphaOrig = alpha;
+    int bestScore = -INF;
+    PackedMove bestMove{};
+    int moveCount = 0;
+    PackedMove quietsSearched[64];      // Quiet moves that failed to cut off, for the history malus
+    int quietCount = 0;
+
+    // Futility: after the first move, a quiet move cannot raise the score enough to matter.
+    // A skipped move may still score up to futilityValue, so the node's fail-low score
+    // is raised to it and the stored upper bound stays sound.
+    auto futileMove = [&](PackedMove m) {
+        if (!futile || moveCount == 0 || isCaptureMove(board, m) || m.isPromotion()
+            || givesCheck(board, m))
+            return false;
+        bestScore = std::max(bestScore, futilityValue);
+        return true;
+    };
+
+    for (PackedMove m = picker.next(); !m.isNull(); m = picker.next()) {
+        if (pool && moveCount == 1 && depth >= YBWC_MIN_SPLIT_DEPTH) {
+            // The younger brothers are split over the pool, so produce them all now
+            MoveList younger;
+            for (; !m.isNull(); m = picker.next()) {
+                if (futileMove(m)) moveCount++;
+                else younger.push_back(m);
+            }
+            moveCount += younger.size();
+            searchSplitPoint(board, younger, depth, alpha, beta, deadline, stop, pool,
+                             bestScore, bestMove, quietsSearched, quietCount);
+            if (alpha >= beta && !isCaptureMove(board, bestMove) && !bestMove.isPromotion())
+                updateQuietStats(board, bestMove, depth, quietsSearched, quietCount);
+            break;
+        }
+        if (futileMove(m)) {
+            moveCount++;
+            continue;
+        }
+        moveCount++;
+        bool quiet = !isCaptureMove(board, m) && !m.isPromotion();
 
-        std::vector<Move> childPV;
-        int score = -negamaxTimed(child, depth - 1, -beta, -alpha, deadline, stop, childPV);
+        int reduction = lateMoveReduction(board, m, depth, moveCount, checked);
+        int score = searchChild(board, m, depth, alpha, beta, moveCount == 1, reduction,
+                                deadline, stop, pool);
 
         if (score > bestScore) {
             bestScore = score;
             bestMove  = m;
-            bestLine  = std::move(childPV);
+            pvt.update(board.ply, m);
         }
 
         if (bestScore > alpha) alpha = bestScore;
         if (alpha >= beta) {
-            // (Optional) record killer/history here
+            if (quiet) updateQuietStats(board, m, depth, quietsSearched, quietCount);
             break;
         }
+        if (quiet && quietCount < 64) quietsSearched[quietCount++] = m;
 
-        if (stop.load() || std::chrono::steady_clock::now() > deadline) break;
+        if (stopped(stop)) break;
     }
 
-    // Build PV
-    pv.clear();
-    if (!(bestMove.fromRow==0 && bestMove.fromCol==0 && bestMove.toRow==0 && bestMove.toCol==0)) {
-        pv.push_back(bestMove);
-        pv.insert(pv.end(), bestLine.begin(), bestLine.end());
+    if (moveCount == 0) {
+        // No legal moves: you can add mate/stalemate detection here to return mate scores.
+        return stmSign(board) * evaluate(board);
+    }
+
+    // An interrupted search returns a partial score that must not be reused
+    if (!stopped(stop)) {
+        uint8_t flag = bestScore <= alphaOrig ? TT_ALPHA : bestScore >= beta ? TT_BETA : TT_EXACT;
+        g_tt.store(board.key, bestScore, depth, flag, bestMove);
     }
     return bestScore;
 }
@@ -1234,7 +1249,57 @@ int alphabetaTimed(BoardData board, int depth, int alpha, int beta, bool /*maxim
 {
     // In negamax we always search from the side-to-move’s perspective.
     // The alpha/beta window is already assumed to be in that perspective.
-    return negamaxTimed(board, depth, alpha, beta, deadline, stop, pv);
+    // The search itself runs on the bitboard Position, converted once here.
+    Position pos(board);
+    int score = negamaxTimed(pos, depth, alpha, beta, deadline, stop);
+    copyPV(pos.ply, pv);
+    return score;
+}
+
+int alphabetaParallel(BoardData board, int depth, int alpha, int beta,
+                      std::chrono::steady_clock::time_point deadline,
+                      std::atomic<bool>& stop, std::vector<Move>& pv, ThreadPool& pool)
+{
+    Position pos(board);
+    int score = negamaxTimed(pos, depth, alpha, beta, deadline, stop, &pool);
+    copyPV(pos.ply, pv);
+    return score;
+}
+
+int aspirationSearch(const BoardData& board, int depth, int prevScore,
+                     std::chrono::steady_clock::time_point deadline,
+                     std::atomic<bool>& stop, std::vector<Move>& pv, ThreadPool* pool)
+{
+    // Widen in 64 bits so a bound near -INF or INF cannot overflow
+    auto bound = [](long long v) { return (int)std::clamp<long long>(v, -INF, INF); };
+    int delta = ASPIRATION_WINDOW;
+    int alpha = -INF, beta = INF;
+    if (depth >= ASPIRATION_MIN_DEPTH) {
+        alpha = bound((long long)prevScore - delta);
+        beta  = bound((long long)prevScore + delta);
+    }
+
+    while (true) {
+        int score = pool ? alphabetaParallel(board, depth, alpha, beta, deadline, stop, pv, *pool)
+                         : alphabetaTimed(board, depth, alpha, beta, board.whiteToMove, deadline, stop, pv);
+        if (stopped(stop)) return score;
+
+        bool failLow  = score <= alpha && alpha > -INF;
+        bool failHigh = !failLow && score >= beta && beta < INF;
+        if (!failLow && !failHigh) return score;
+        // Out of time with only a bound: flag the iteration as interrupted, so callers
+        // that check stop do not take the bound and its PV for a finished search
+        if (std::chrono::steady_clock::now() > deadline) {
+            stop.store(true, std::memory_order_relaxed);
+            return score;
+        }
+
+        // Fail low or high: the true score is beyond that bound, so move it past the
+        // returned score and double the margin for the next try
+        if (failLow) alpha = bound((long long)score - delta);
+        else         beta  = bound((long long)score + delta);
+        delta *= 2;
+    }
 }
 
 int old_alphabetaTimed(BoardData board, int depth, int alpha, int beta, bool maximizing,
@@ -1245,7 +1310,7 @@ int old_alphabetaTimed(BoardData board, int depth, int alpha, int beta, bool max
     // Alpha is the best value that the maximizer currently can guarantee at that level or above.
     // Beta is the best value that the minimizer currently can guarantee at that level or below.
 
-    g_nodes.fetch_add(1, std::memory_order_relaxed);          // <-- count this node
+    g_ctx.stats.addNode();
     if (stop.load() || std::chrono::steady_clock::now() > deadline) return 0;
     if (board.halfmoveClock >= 100) return 0; // Draw by 50-move rule
     if (depth == 0) 
@@ -2,13 +2,15 @@
 
 #pragma once
 #include "engine.h"
+#include "position.h"
+#include "movelist.h"
 
 #include <vector>
 #include <chrono>
 #include <atomic>
 #include <cstdint>
 
-extern std::atomic<uint64_t> g_nodes;
+class ThreadPool;
 
 #define DOUBLED_PAWN_PENALTY		10
 #define ISOLATED_PAWN_PENALTY		20
@@ -98,6 +100,7 @@ const int mirror[64] = {
 };
 
 int evaluate(const BoardData& state);
+int evaluate(const Position& pos);
 int eval_white_pawn(int sq);
 int eval_black_pawn(int sq);
 int eval_white_king(int sq);
@@ -106,16 +109,61 @@ int eval_black_king(int sq);
 int eval_bkp(int f);
 bool isCheckMate(const BoardData& board, const Move& move);
 bool inCheck(const BoardData& board, int side);
+bool inCheck(const Position& pos, int side);
 bool attacked(const BoardData& board, int sq, int side);
+bool attacked(const Position& pos, int sq, int side);
 bool pawn_attack(const BoardData& board, int sq, int side);
+// Static Exchange Evaluation: material won (centipawns) by the side playing m if both
+// sides then keep recapturing on its target square while it pays them.
+int see(const Position& pos, PackedMove m);
+// True for a capture that loses material once the exchange on its square is played out
+bool losingCapture(const Position& pos, PackedMove m);
+// Kinds of legal moves for generateMoves(pos, genType, list)
+#define GEN_ALL         0
+#define GEN_CAPTURES    1   // Captures, en passant and all promotions
+#define GEN_QUIETS      2   // Every other move, including castling
+
+// The Position generators return a MoveList and allocate nothing; the BoardData
+// versions are for the interfaces that work on BoardData.
+std::vector<Move> generatePseudoLegalMoves(const BoardData& board);
+MoveList generatePseudoLegalMoves(const Position& pos);
 std::vector<Move> generateMoves(const BoardData& state);
+MoveList generateMoves(const Position& pos);
+void generateMoves(const Position& pos, int genType, MoveList& list);    // Appends to list
+// True if m is a legal move in pos, for moves that did not come from the generator
+bool isLegalMove(const Position& pos, PackedMove m);
+std::vector<Move> generatePseudoLegalCaptures(const BoardData& board);
+MoveList generatePseudoLegalCaptures(const Position& pos);
 std::vector<Move> generateCaptures(const BoardData& board);
+MoveList generateCaptures(const Position& pos);
 std::vector<Move> sortMoves(std::vector<Move>& moves, const BoardData& board);
+// Null move, razoring, futility and delta pruning and late move reductions. With them
+// off the search is plain alpha-beta, whose score does not depend on move order, which
+// lets tests compare searches exactly. Only change it while no search is running.
+extern bool g_selectiveSearch;
 // Timed alpha-beta (implemented via negamax internally)
 int alphabetaTimed(BoardData board, int depth, int alpha, int beta, bool /* maximizing ignored */,
                    std::chrono::steady_clock::time_point deadline, std::atomic<bool>& stop, std::vector<Move>& pv);
+// Same search with interior nodes split over the pool's threads (Young Brothers Wait).
+// The calling thread takes part in the search.
+int alphabetaParallel(BoardData board, int depth, int alpha, int beta,
+                      std::chrono::steady_clock::time_point deadline,
+                      std::atomic<bool>& stop, std::vector<Move>& pv, ThreadPool& pool);
+// One iteration of iterative deepening. From ASPIRATION_MIN_DEPTH on, the search starts
+// with a window of +-ASPIRATION_WINDOW around the previous iteration's score and widens
+// it on the failing side until the score falls inside. With a pool it runs YBWC.
+// The result is only final if stop is clear afterwards: stop is also set when the
+// deadline passes while the score is still just a bound.
+#define ASPIRATION_MIN_DEPTH    4
+#define ASPIRATION_WINDOW       25
+int aspirationSearch(const BoardData& board, int depth, int prevScore,
+                     std::chrono::steady_clock::time_point deadline,
+                     std::atomic<bool>& stop, std::vector<Move>& pv, ThreadPool* pool = nullptr);
 // Timed negamax quiescence (captures only), with PV
 int quiescenceTimed(BoardData& board, int alpha, int beta, int qdepth,
                     std::chrono::steady_clock::time_point deadline,
                     std::atomic<bool>& stop, std::vector<Move>& pv);
+int quiescenceTimed(Position& pos, int alpha, int beta, int qdepth,
+                    std::chrono::steady_clock::time_point deadline,
+                    std::atomic<bool>& stop, std::vector<Move>& pv);
 Move findBestMoveParallel(BoardData state, int depth, int timeLimitMs);
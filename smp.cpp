@@ -0,0 +1,88 @@
+// smp.cpp
+// Lazy SMP: persistent helper threads searching the main thread's root through a shared TT.
+
+#include "smp.h"
+#include "search.h"
+#include "thread_context.h"
+
+#include <chrono>
+
+namespace {
+    // Helper i skips depth d when ((d + skipPhase[i]) / skipSize[i]) is odd, so the
+    // helpers split into groups that work one, two, three or four iterations apart.
+    const int SKIP_COUNT = 20;
+    const int skipSize[SKIP_COUNT]  = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+    const int skipPhase[SKIP_COUNT] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+}
+
+LazySMP::~LazySMP() {
+    setHelpers(0);
+}
+
+void LazySMP::setHelpers(int n) {
+    if (n == (int)threads.size()) return;
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        quit = true;
+    }
+    wakeCv.notify_all();
+    for (auto& t : threads) t.join();
+    threads.clear();
+
+    quit = false;
+    for (int i = 0; i < n; ++i)
+        threads.emplace_back(&LazySMP::helperLoop, this, i, searchId);
+}
+
+void LazySMP::start(const BoardData& r, int depth, std::atomic<bool>& s) {
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        root = r;
+        maxDepth = depth;
+        stop = &s;
+        busy = (int)threads.size();
+        searchId++;
+    }
+    wakeCv.notify_all();
+}
+
+void LazySMP::wait() {
+    std::unique_lock<std::mutex> lk(mu);
+    idleCv.wait(lk, [this] { return busy == 0; });
+}
+
+// seen is the last search the helper should ignore, i.e. the one current when it was created
+void LazySMP::helperLoop(int id, uint64_t seen) {
+    for (;;) {
+        BoardData board;
+        int depthLimit;
+        std::atomic<bool>* stopFlag;
+        {
+            std::unique_lock<std::mutex> lk(mu);
+            wakeCv.wait(lk, [&] { return quit || searchId != seen; });
+            if (quit) return;
+            seen = searchId;
+            board = root;
+            depthLimit = maxDepth;
+            stopFlag = stop;
+        }
+        g_ctx.prepareSearch();
+
+        // Only the main thread watches the clock
+        auto noDeadline = std::chrono::steady_clock::time_point::max();
+        int i = id % SKIP_COUNT;
+        int score = 0;
+        for (int d = 1; d <= depthLimit && !stopFlag->load(); ++d) {
+            if (((d + skipPhase[i]) / skipSize[i]) % 2) continue;
+            std::vector<Move> pv;
+            score = aspirationSearch(board, d, score, noDeadline, *stopFlag, pv);
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(mu);
+            busy--;
+        }
+        idleCv.notify_all();
+    }
+}
@@ -0,0 +1,50 @@
+// smp.h
+
+#pragma once
+
+#include "engine.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Lazy SMP helper threads.
+//
+// The helpers are created once and sleep between searches. For each search they run
+// their own iterative deepening on the same root as the main thread, skipping some
+// depths so that they spread over different iterations, and share results with it
+// only through the transposition table. The main thread keeps the time control and
+// reports bestmove; it ends the helpers' work by setting the shared stop flag.
+class LazySMP {
+public:
+    LazySMP() = default;
+    ~LazySMP();
+
+    // Number of helper threads, not counting the main search thread.
+    // Must not be called while a search is running.
+    void setHelpers(int n);
+    int helpers() const { return (int)threads.size(); }
+
+    // Wake every helper to search root up to maxDepth until stop is set.
+    void start(const BoardData& root, int maxDepth, std::atomic<bool>& stop);
+
+    // Block until every helper has finished the current search.
+    void wait();
+
+private:
+    void helperLoop(int id, uint64_t seen);
+
+    std::vector<std::thread> threads;
+    std::mutex mu;
+    std::condition_variable wakeCv, idleCv;
+    uint64_t searchId = 0;      // Bumped by start() to wake the helpers
+    int  busy = 0;              // Helpers still searching
+    bool quit = false;
+
+    BoardData root;
+    int maxDepth = 0;
+    std::atomic<bool>* stop = nullptr;
+};
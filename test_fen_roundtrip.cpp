@@ -1,6 +1,7 @@
 
 #include "fen.h"
 #include "engine.h"
+#include "position.h"
 #include <iostream>
 #include <vector>
 #include <cassert>
@@ -12,6 +13,9 @@ void testFENRoundTrip(const std::string& fen) {
         std::cout << "Original FEN    : " << fen << std::endl;
         std::cout << "Round-tripped FEN: " << roundtrip << std::endl;
         assert(fen == roundtrip && "FEN mismatch after roundtrip conversion!");
+        // The bitboard Position must carry the same information as BoardData
+        std::string viaPosition = boardToFEN(Position(board).toBoard());
+        assert(fen == viaPosition && "FEN mismatch after BoardData -> Position -> BoardData conversion!");
         std::cout << "✅ Round-trip successful\n" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "❌ Exception during test: " << e.what() << std::endl;
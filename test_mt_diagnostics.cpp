@@ -172,7 +172,6 @@ int main(int argc, char** argv) {
             // Ensure fresh thread-local heuristic state for this worker
             if (useThreadLocals) {
                 g_ctx.resetAll();
-                g_ctx.age = 0; // or loop/depth if you want to track ages
             }
             for (;;) {
                 size_t k = next.fetch_add(1, std::memory_order_relaxed);
@@ -181,7 +180,6 @@ int main(int argc, char** argv) {
 
                 if (useThreadLocals && resetCtxEachRep) {
                     g_ctx.resetAll();
-                    g_ctx.age = 0;
                 }
 
                 std::vector<Move> pv;
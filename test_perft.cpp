@@ -0,0 +1,148 @@
+// test_perft.cpp
+// Counts the leaf nodes of the legal move tree to a fixed depth and compares them with
+// published perft results. Any mismatch points at a move generation or make move bug.
+
+#include "engine.h"
+#include "fen.h"
+#include "position.h"
+#include "search.h"
+
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+// The legal generator must keep exactly the pseudo legal moves that do not leave
+// the mover in check
+static void checkLegalMoves(Position& pos, const MoveList& legal) {
+    int side = pos.sideToMove();
+    int kept = 0;
+    for (const auto& m : generatePseudoLegalMoves(pos)) {
+        pos.makeMove(m);
+        bool ok = !inCheck(pos, side);
+        pos.unmakeMove(m);
+        assert(isLegalMove(pos, m) == ok && "isLegalMove disagrees with make/unmake");
+        if (!ok) continue;
+        kept++;
+        assert(std::find(legal.begin(), legal.end(), m) != legal.end() && "Legal move not generated");
+    }
+    assert(kept == legal.size() && "Illegal move generated");
+
+    // The quiescence generator keeps exactly the captures and promotions
+    MoveList caps = generateCaptures(pos);
+    int tactical = 0;
+    for (const auto& m : legal) {
+        if (pos.squares[m.to()] == NO_PIECE && !m.isEnPassant() && !m.isPromotion()) continue;
+        tactical++;
+        assert(std::find(caps.begin(), caps.end(), m) != caps.end() && "Capture or promotion not generated");
+    }
+    assert(tactical == caps.size() && "Quiet move generated as a capture");
+
+    // The quiet moves are all the rest
+    MoveList quiets;
+    generateMoves(pos, GEN_QUIETS, quiets);
+    assert(tactical + quiets.size() == legal.size() && "Captures and quiets do not add up");
+    for (const auto& m : quiets)
+        assert(std::find(legal.begin(), legal.end(), m) != legal.end() && std::find(caps.begin(), caps.end(), m) == caps.end());
+}
+
+// isLegalMove accepts exactly the generated moves among every from/to/flag combination
+static void checkAllMoves(const Position& pos) {
+    MoveList legal = generateMoves(pos);
+    const int flags[] = { MOVE_NORMAL, MOVE_CASTLING, MOVE_EN_PASSANT, MOVE_PROMOTION, MOVE_PROMOTION | 3 };
+    for (int from = 0; from < 64; ++from)
+        for (int to = 0; to < 64; ++to)
+            for (int flag : flags) {
+                PackedMove m(from, to, flag);
+                bool generated = std::find(legal.begin(), legal.end(), m) != legal.end();
+                assert(isLegalMove(pos, m) == generated && "isLegalMove accepts a move the generator does not");
+            }
+}
+
+uint64_t perft(Position& pos, int depth) {
+    if (depth == 0) return 1;
+    auto moves = generateMoves(pos);
+    checkLegalMoves(pos, moves);
+    if (depth == 1) return moves.size();
+    uint64_t nodes = 0;
+    for (const auto& m : moves) {
+        pos.makeMove(m);
+        // The incrementally updated key must match a full rescan
+        assert(pos.key == pos.computeKey() && "Incremental Zobrist key mismatch");
+        assert(pos.kingSquare(WHITE) == lsb(pos.pieces(WHITE, KING)) && "White king square not tracked");
+        assert(pos.kingSquare(BLACK) == lsb(pos.pieces(BLACK, KING)) && "Black king square not tracked");
+        nodes += perft(pos, depth - 1);
+        pos.unmakeMove(m);
+    }
+    return nodes;
+}
+
+struct PerftCase {
+    std::string fen;
+    int depth;
+    uint64_t expected;
+};
+
+int main() {
+    std::vector<PerftCase> cases = {
+        // Starting position
+        { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4, 197281 },
+        // "Kiwipete": castling, pins, en passant and promotions
+        { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3, 97862 },
+        // En passant discovered check along the rank
+        { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624 },
+        // Promotions and castling rights lost by capture
+        { "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333 },
+        { "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62379 },
+        { "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 3, 89890 },
+        // En passant that gives check, and one that would expose the king
+        { "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 5, 206379 },
+        { "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 5, 185429 },
+        // Castling through attacked squares, and escaping discovered checks
+        { "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 3, 50509 },
+        { "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 4, 31961 },
+    };
+
+    for (const auto& c : cases) {
+        Position pos(loadFEN(c.fen));
+        checkAllMoves(pos);
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = perft(pos, c.depth);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << c.fen << " depth " << c.depth << ": " << nodes
+                  << " (expected " << c.expected << ") in " << ms << " ms" << std::endl;
+        assert(nodes == c.expected && "Perft node count mismatch");
+        // Every makeMove must have been undone exactly
+        assert(boardToFEN(pos.toBoard()) == c.fen && "Position changed by make/unmake");
+        assert(pos.key == g_zobrist.computeHash(pos.toBoard()) && "Zobrist key changed by make/unmake");
+    }
+
+    // Shuffling both knights out and back repeats the start position
+    {
+        Position pos(loadFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"));
+        // Rows count from rank 8: g1 = (7,6), f3 = (5,5), g8 = (0,6), f6 = (2,5)
+        Move shuffle[4] = { {7,6,5,5}, {0,6,2,5}, {5,5,7,6}, {2,5,0,6} };
+        for (const auto& m : shuffle) {
+            assert(!pos.isRepetition());
+            pos.makeMove(m);
+        }
+        assert(pos.isRepetition() && "Knight shuffle should repeat the start position");
+    }
+
+    // A null move clears en passant and flips the side, and unmaking it restores both
+    {
+        const std::string fen = "rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 3";
+        Position pos(loadFEN(fen));
+        pos.makeNullMove();
+        assert(pos.whiteToMove && pos.enPassantTarget == -1);
+        assert(pos.key == pos.computeKey() && "Null move key mismatch");
+        assert(pos.playedMove(1).isNull() && pos.playedPiece(1) == NO_PIECE);
+        pos.unmakeNullMove();
+        assert(boardToFEN(pos.toBoard()) == fen && pos.key == pos.computeKey());
+    }
+
+    std::cout << "✅ All perft tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,43 @@
+// test_see.cpp
+// Static Exchange Evaluation of captures, including x-ray recaptures.
+
+#include "engine.h"
+#include "fen.h"
+#include "position.h"
+#include "search.h"
+
+#include <iostream>
+#include <cassert>
+#include <string>
+
+// Square index of an algebraic square name such as "e5"
+static int sq(const char* name) {
+    return SQUARE('8' - name[1], name[0] - 'a');
+}
+
+static int seeOf(const std::string& fen, const char* from, const char* to, int flag = MOVE_NORMAL) {
+    Position pos(loadFEN(fen));
+    int score = see(pos, PackedMove(sq(from), sq(to), flag));
+    std::cout << fen << " " << from << to << ": " << score << std::endl;
+    return score;
+}
+
+int main() {
+    // Undefended pawn
+    assert(seeOf("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1", "e5") == 100);
+    // Knight for a pawn after the exchange on e5 plays out
+    assert(seeOf("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3", "e5") == -220);
+    // Queen takes a pawn defended by a pawn
+    assert(seeOf("4k3/8/3p4/4p3/8/8/8/4Q1K1 w - - 0 1", "e1", "e5") == -800);
+    // The rook behind the capturing rook recaptures through it
+    assert(seeOf("4k3/4r3/8/4p3/8/8/4R3/4R1K1 w - - 0 1", "e2", "e5") == 100);
+    // The king may only take an undefended piece
+    assert(seeOf("4k3/8/8/8/8/8/3p4/4K3 w - - 0 1", "e1", "d2") == 100);
+    assert(seeOf("4k3/8/8/8/8/4p3/3p4/4K3 w - - 0 1", "e1", "d2") < 0);
+    // En passant, then the same capture recaptured by a pawn
+    assert(seeOf("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5", "d6", MOVE_EN_PASSANT) == 100);
+    assert(seeOf("4k3/2p5/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5", "d6", MOVE_EN_PASSANT) == 0);
+
+    std::cout << "✅ All SEE tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,68 @@
+// test_timeman.cpp
+// Soft and hard time limits, and the timer that sets the stop flag at a deadline.
+
+#include "timeman.h"
+
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+int main() {
+    // movetime is both limits; no clock at all gives the default
+    TimeLimits t = computeTimeLimits(-1, 0, 0, 500, 1000);
+    assert(t.softMs == 500 && t.hardMs == 500);
+    t = computeTimeLimits(-1, 0, 0, -1, 1000);
+    assert(t.softMs == 1000 && t.hardMs == 1000);
+
+    // 60 s sudden death: a 30th of the clock, stretchable up to three times that
+    t = computeTimeLimits(60000, 0, 0, -1, 1000);
+    assert(t.softMs == 2000 && t.hardMs == 6000);
+    // Low on time the hard limit is capped by the remaining time, but not below soft
+    t = computeTimeLimits(2000, 1000, 0, -1, 1000);
+    assert(t.softMs == 566 && t.hardMs == 566);
+
+    // The timer sets the flag once the deadline passes, and not if cancelled first
+    {
+        std::atomic<bool> stop(false);
+        DeadlineTimer timer;
+        timer.start(std::chrono::steady_clock::now() + std::chrono::milliseconds(20), stop);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        assert(stop.load() && "Timer did not fire");
+    }
+    {
+        std::atomic<bool> stop(false);
+        DeadlineTimer timer;
+        timer.start(std::chrono::steady_clock::now() + std::chrono::milliseconds(50), stop);
+        timer.cancel();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        assert(!stop.load() && "Cancelled timer fired");
+    }
+
+    // One timer serves search after search: re-arming replaces the deadline, and a
+    // cancelled timer can be armed again
+    {
+        std::atomic<bool> first(false), second(false);
+        DeadlineTimer timer;
+        timer.start(std::chrono::steady_clock::now() + std::chrono::milliseconds(20), first);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        assert(first.load() && "Timer did not fire");
+        timer.start(std::chrono::steady_clock::now() + std::chrono::hours(1), second);
+        timer.start(std::chrono::steady_clock::now() + std::chrono::milliseconds(20), second);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        assert(second.load() && "Re-armed timer did not fire");
+
+        second = false;
+        timer.start(std::chrono::steady_clock::now() + std::chrono::milliseconds(50), second);
+        timer.cancel();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        assert(!second.load() && "Cancelled timer fired");
+        timer.start(std::chrono::steady_clock::now() + std::chrono::milliseconds(20), second);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        assert(second.load() && "Timer did not fire after a cancel");
+    }
+
+    std::cout << "✅ All time management tests passed." << std::endl;
+    return 0;
+}
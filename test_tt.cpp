@@ -0,0 +1,63 @@
+// test_tt.cpp
+// Store/probe round trips, replacement and concurrent access for the shared
+// transposition table.
+
+#include "engine.h"
+#include "tt.h"
+
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+int main() {
+    TransTable tt(1);
+
+    // Round trip, including a negative score and a promotion move
+    PackedMove best(SQUARE(1, 4), SQUARE(0, 4), MOVE_PROMOTION | (KNIGHT - KNIGHT));
+    tt.store(0x1234567890ABCDEFULL, -321, 7, TT_BETA, best);
+    TTEntry e;
+    assert(tt.probe(0x1234567890ABCDEFULL, e));
+    assert(e.score == -321 && e.depth == 7 && e.flag == TT_BETA);
+    assert(e.best == best && e.best.promotionType() == KNIGHT);
+    assert(!tt.probe(0x1234567890ABCDEEULL, e) && "A different key must miss");
+
+    // A shallower non-exact result from the same search keeps the deeper entry,
+    // and a fail-low without a best move keeps the stored move
+    tt.store(0x1234567890ABCDEFULL, 50, 2, TT_ALPHA, PackedMove{});
+    assert(tt.probe(0x1234567890ABCDEFULL, e) && e.depth == 7);
+    tt.store(0x1234567890ABCDEFULL, 50, 6, TT_ALPHA, PackedMove{});
+    assert(tt.probe(0x1234567890ABCDEFULL, e) && e.depth == 6 && e.best == best);
+
+    // Fill the table in one generation, then check hashfull and that a new
+    // generation's entries replace the stale ones
+    for (uint64_t k = 1; k < 200000; ++k) tt.store(k * 0x9E3779B97F4A7C15ULL, 0, 3, TT_EXACT, PackedMove{});
+    int full = tt.hashfull();
+    std::cout << "hashfull after fill: " << full << std::endl;
+    assert(full > 900);
+    tt.newSearch();
+    assert(tt.hashfull() == 0);
+    for (uint64_t k = 1; k < 200000; ++k) tt.store(k * 0xC2B2AE3D27D4EB4FULL, 0, 1, TT_EXACT, PackedMove{});
+    assert(tt.hashfull() > 900 && "Older generations should be replaced first");
+
+    // Threads hammering the same few clusters must never read a torn entry:
+    // every hit has to carry the score and depth written together with its key.
+    tt.clear();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&tt, t]() {
+            TTEntry r;
+            for (int i = 0; i < 200000; ++i) {
+                uint64_t key = (uint64_t)(i % 64 + 1) * 0x9E3779B97F4A7C15ULL;
+                int tag = (int)(key >> 56);
+                tt.store(key, tag, (t + i) % 50 + 1, TT_EXACT, PackedMove{});
+                if (tt.probe(key, r)) assert(r.score == tag && r.depth >= 1 && r.depth <= 50);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    std::cout << "✅ All transposition table tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,92 @@
+// test_ybwc.cpp
+// Work-stealing thread pool and the Young Brothers Wait split-point search.
+
+#include "engine.h"
+#include "fen.h"
+#include "search.h"
+#include "threadpool.h"
+#include "tt.h"
+#include "position.h"
+#include "thread_context.h"
+
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Tasks that submit and wait for their own subtasks, like nested split points.
+// Waiting threads must keep running tasks or the pool deadlocks.
+static long long treeSum(ThreadPool& pool, int depth) {
+    if (depth == 0) return 1;
+    std::atomic<long long> sum{0};
+    std::atomic<int> pending{4};
+    for (int i = 0; i < 4; ++i) {
+        pool.submit([&pool, &sum, &pending, depth]() {
+            sum += treeSum(pool, depth - 1);
+            pending--;
+        });
+    }
+    pool.helpUntil([&pending] { return pending.load() == 0; });
+    return sum;
+}
+
+int main() {
+    {
+        ThreadPool pool(4);
+        assert(treeSum(pool, 6) == 4096);
+        auto f = pool.enqueue([] { return 42; });
+        assert(f.get() == 42);
+    }
+    {
+        // A pool without workers still completes work run by the waiting thread
+        ThreadPool pool(0);
+        assert(treeSum(pool, 3) == 64);
+    }
+
+    // Alpha-beta with a full window returns the minimax value whatever the move order,
+    // so with the selective search off YBWC must match the serial search exactly.
+    // Depth 3 keeps repetitions out of the tree. With pruning and reductions on, the
+    // score depends on move order and on each thread's killers and history, so only
+    // the principal variation is checked then.
+    const std::vector<std::string> fens = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    };
+    const int INF = 1000000;
+    ThreadPool pool(4);
+    auto far = std::chrono::steady_clock::now() + std::chrono::hours(1);
+    for (bool selective : { false, true }) {
+        g_selectiveSearch = selective;
+        for (const auto& fen : fens) {
+            BoardData board = loadFEN(fen);
+            std::atomic<bool> stop(false);
+            std::vector<Move> pv;
+
+            g_tt.clear();
+            int serial = alphabetaTimed(board, 3, -INF, INF, board.whiteToMove, far, stop, pv);
+            g_tt.clear();
+            resetSearchStats();
+            int parallel = alphabetaParallel(board, 3, -INF, INF, far, stop, pv, pool);
+            // Nodes searched by the pool's threads count in the totals as well
+            SearchTotals totals = collectSearchStats();
+            assert(totals.nodes > 0 && totals.qnodes <= totals.nodes);
+
+            std::cout << fen << (selective ? " (selective)" : "") << ": serial " << serial
+                      << ", YBWC " << parallel << std::endl;
+            assert((selective || serial == parallel) && "YBWC score differs from the serial search");
+            assert(!pv.empty());
+            Position pos(board);
+            for (const auto& m : pv) {
+                assert(isLegalMove(pos, packMove(m)) && "YBWC PV contains an illegal move");
+                pos.makeMove(m);
+            }
+        }
+    }
+    g_selectiveSearch = true;
+
+    std::cout << "✅ All YBWC tests passed." << std::endl;
+    return 0;
+}
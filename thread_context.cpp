@@ -1,3 +1,84 @@
 #include "thread_context.h"
 
-thread_local ThreadContext g_ctx; // default TT size; can be re-inited per thread if desired
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+thread_local ThreadContext g_ctx;
+
+namespace {
+    // The SearchStats of the live threads, and the counts left by threads that exited
+    struct StatsRegistry {
+        std::mutex mu;
+        std::vector<SearchStats*> live;
+        SearchTotals retired;
+    };
+
+    std::atomic<uint64_t> currentGame{0};   // Bumped by newGame()
+
+    // Built on first use and never destroyed: the threads of static pools such as the
+    // UCI search thread and the Lazy SMP helpers end, and deregister their g_ctx, while
+    // the statics are being destroyed, in no order that could be relied on
+    StatsRegistry& registry() {
+        static StatsRegistry* r = new StatsRegistry;
+        return *r;
+    }
+
+    void addTo(SearchTotals& t, const SearchStats& s) {
+        t.nodes  += s.nodes.load(std::memory_order_relaxed);
+        t.qnodes += s.qnodes.load(std::memory_order_relaxed);
+        t.ttHits += s.ttHits.load(std::memory_order_relaxed);
+    }
+}
+
+ThreadContext::ThreadContext() : eval(), history(), killers(), counters(), contHistory() {
+    pvTables.push_back(std::make_unique<PVTable>());
+    pvTable = pvTables[0].get();
+
+    StatsRegistry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mu);
+    r.live.push_back(&stats);
+}
+
+ThreadContext::~ThreadContext() {
+    StatsRegistry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mu);
+    addTo(r.retired, stats);
+    r.live.erase(std::find(r.live.begin(), r.live.end(), &stats));
+}
+
+void ThreadContext::enterTask() {
+    if (++pvLevel == (int)pvTables.size()) pvTables.push_back(std::make_unique<PVTable>());
+    pvTable = pvTables[pvLevel].get();
+}
+
+void ThreadContext::prepareSearch() {
+    uint64_t g = currentGame.load(std::memory_order_relaxed);
+    if (g != game) {
+        resetAll();
+        game = g;
+    }
+}
+
+void newGame() {
+    currentGame.fetch_add(1, std::memory_order_relaxed);
+}
+
+SearchTotals collectSearchStats() {
+    StatsRegistry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mu);
+    SearchTotals t = r.retired;
+    for (const SearchStats* s : r.live) addTo(t, *s);
+    return t;
+}
+
+void resetSearchStats() {
+    StatsRegistry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mu);
+    r.retired = SearchTotals{};
+    for (SearchStats* s : r.live) {
+        s->nodes.store(0, std::memory_order_relaxed);
+        s->qnodes.store(0, std::memory_order_relaxed);
+        s->ttHits.store(0, std::memory_order_relaxed);
+    }
+}
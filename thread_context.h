@@ -1,17 +1,111 @@
 #pragma once
 #include "heuristics.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Counts kept by one search thread. Only the owning thread writes them, with a relaxed
+// load and store rather than a locked add, and each thread's counts sit on their own
+// cache line, so counting costs the same with any number of threads. Other threads
+// read them through collectSearchStats().
+struct alignas(64) SearchStats {
+    std::atomic<uint64_t> nodes{0};     // Main search and quiescence nodes
+    std::atomic<uint64_t> qnodes{0};    // Quiescence nodes alone
+    std::atomic<uint64_t> ttHits{0};    // Transposition table probes that found an entry
+
+    void addNode()  { bump(nodes); }
+    void addQNode() { bump(nodes); bump(qnodes); }
+    void addTTHit() { bump(ttHits); }
+
+private:
+    static void bump(std::atomic<uint64_t>& c) {
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+};
+
+// Sum of the SearchStats of every thread
+struct SearchTotals {
+    uint64_t nodes = 0;
+    uint64_t qnodes = 0;
+    uint64_t ttHits = 0;
+};
+
+// Triangular principal variation table. Row ply holds the best line found so far from
+// the node at that ply, in moves[ply][ply .. length[ply]). A node empties its row when
+// it starts, and when a move becomes its best it writes the move followed by the row of
+// the child, which the child's search has just filled in.
+struct PVTable {
+    static constexpr int MAX_PLY = 128;
+    PackedMove moves[MAX_PLY][MAX_PLY];
+    int length[MAX_PLY];
+
+    void clear(int ply) {
+        if (ply < MAX_PLY) length[ply] = ply;
+    }
+    // m is now the best move at ply, and the child's row its continuation
+    void update(int ply, PackedMove m) {
+        if (ply + 1 < MAX_PLY) update(ply, m, line(ply + 1), size(ply + 1));
+        else if (ply < MAX_PLY) {
+            moves[ply][ply] = m;    // The last row has no room for a continuation
+            length[ply] = ply + 1;
+        }
+    }
+    // Same with the continuation given, for a line found on another thread
+    void update(int ply, PackedMove m, const PackedMove* cont, int n) {
+        if (ply >= MAX_PLY) return;
+        n = std::min(n, MAX_PLY - 1 - ply);
+        moves[ply][ply] = m;
+        if (n > 0) std::copy(cont, cont + n, &moves[ply][ply + 1]);
+        length[ply] = ply + 1 + n;
+    }
+    int size(int ply) const { return ply < MAX_PLY ? length[ply] - ply : 0; }
+    const PackedMove* line(int ply) const { return &moves[ply][ply]; }     // ply < MAX_PLY
+};
+
+// Per-thread search state. The transposition table is shared by all threads (g_tt in tt.h).
 struct ThreadContext {
     EvalMatrix   eval;
     HistoryTable history;
     KillerTable  killers;
-    TransTable   tt;
-    uint16_t     age = 0;
+    CounterMoveTable    counters;
+    ContinuationHistory contHistory;
+    SearchStats  stats;
+
+    // PV tables: one for the thread's own search, and one more for each level of split
+    // point tasks it runs (enterTask), so the tasks a thread picks up while it waits at a
+    // split point cannot overwrite the lines of the nodes it is waiting in
+    std::vector<std::unique_ptr<PVTable>> pvTables;
+    PVTable* pvTable;
+    int pvLevel = 0;
+
+    void enterTask();
+    void leaveTask() { pvTable = pvTables[--pvLevel].get(); }
+
+    // Registers stats for collectSearchStats(); a thread's counts outlive the thread
+    ThreadContext();
+    ~ThreadContext();
+    ThreadContext(const ThreadContext&) = delete;
+    ThreadContext& operator=(const ThreadContext&) = delete;
 
-    ThreadContext(size_t ttSize = (1u<<20)) : eval(), history(), killers(), tt(ttSize) {}
-    
     void clearPlyData() { killers.clear(); }
-    void resetAll() { eval.clear();  history.clear(); killers.clear(); tt.clear(); }
+    void resetAll() { eval.clear();  history.clear(); killers.clear(); counters.clear(); contHistory.clear(); }
+
+    // Called by a thread before it takes part in a search: clears the tables above if
+    // a new game has started since it last searched
+    void prepareSearch();
+    uint64_t game = 0;
 };
 
 extern thread_local ThreadContext g_ctx; // one per thread
+
+// Start a new game. Search threads are long-lived and keep their history, killers and
+// counter moves from one search to the next; each clears them at its next prepareSearch().
+void newGame();
+
+// Totals over all threads, including ones that have exited since the last reset
+SearchTotals collectSearchStats();
+// Zero every thread's counts, before a search starts
+void resetSearchStats();
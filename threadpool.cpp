@@ -1,29 +1,83 @@
-
 #include "threadpool.h"
 
+#include <algorithm>
+
+namespace {
+    // The pool and deque index of the current thread, if it is a pool worker
+    thread_local const ThreadPool* currentPool = nullptr;
+    thread_local size_t currentIndex = 0;
+}
+
 ThreadPool::ThreadPool(size_t n) : stop(false) {
+    for (size_t i = 0; i < std::max<size_t>(n, 1); ++i)
+        queues.push_back(std::make_unique<WorkQueue>());
     for (size_t i = 0; i < n; ++i)
-        workers.emplace_back([this] {
-            while (true) {
-                std::function<void()> task;
-                {
-                    std::unique_lock<std::mutex> lock(queue_mutex);
-                    condition.wait(lock, [this] { return stop || !tasks.empty(); });
-                    if (stop && tasks.empty()) return;
-                    task = std::move(tasks.front());
-                    tasks.pop();
-                }
-                task();
-            }
-        });
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
 }
 
 ThreadPool::~ThreadPool() {
     {
-        std::unique_lock<std::mutex> lock(queue_mutex);
+        std::unique_lock<std::mutex> lock(sleepMutex);
         stop = true;
     }
     condition.notify_all();
     for (std::thread &worker : workers)
         worker.join();
 }
+
+void ThreadPool::submit(std::function<void()> task) {
+    if (currentPool == this) {
+        WorkQueue& q = *queues[currentIndex];
+        std::lock_guard<std::mutex> lock(q.mu);
+        q.tasks.push_front(std::move(task));
+    } else {
+        WorkQueue& q = *queues[nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size()];
+        std::lock_guard<std::mutex> lock(q.mu);
+        q.tasks.push_back(std::move(task));
+    }
+    {
+        // Count under the sleep mutex so a worker about to sleep cannot miss it
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued++;
+    }
+    condition.notify_one();
+}
+
+bool ThreadPool::runOne() {
+    std::function<void()> task;
+    size_t n = queues.size();
+    size_t self = currentPool == this ? currentIndex : 0;
+
+    if (currentPool == this) {
+        WorkQueue& q = *queues[self];
+        std::lock_guard<std::mutex> lock(q.mu);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+    }
+    for (size_t k = 1; !task && k <= n; ++k) {
+        WorkQueue& q = *queues[(self + k) % n];
+        std::lock_guard<std::mutex> lock(q.mu);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        }
+    }
+    if (!task) return false;
+
+    queued--;
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(size_t id) {
+    currentPool = this;
+    currentIndex = id;
+    while (true) {
+        if (runOne()) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        condition.wait(lock, [this] { return stop || queued > 0; });
+        if (stop) return;
+    }
+}
@@ -1,13 +1,24 @@
-
 #pragma once
 #include <vector>
 #include <thread>
-#include <queue>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
 #include <future>
 
+// Work-stealing thread pool.
+//
+// Every worker owns a deque of tasks. A worker pushes the tasks it creates onto the
+// front of its own deque and takes work from the front (newest first, so it stays in
+// the subtree it is searching); an idle worker steals from the back of another deque
+// (oldest first, so it takes the largest pieces of work). Tasks submitted from outside
+// the pool are spread round-robin over the deques.
+//
+// A thread that must wait for tasks it submitted calls helpUntil() and runs queued
+// tasks meanwhile, so nested waits cannot starve the pool.
 class ThreadPool {
 public:
     ThreadPool(size_t n);
@@ -16,11 +27,29 @@ public:
     template<class F>
     auto enqueue(F&& f) -> std::future<decltype(f())>;
 
+    void submit(std::function<void()> task);
+
+    // Run queued tasks on the calling thread until done() returns true.
+    template<class Pred>
+    void helpUntil(Pred done);
+
+    size_t size() const { return workers.size(); }
+
 private:
+    struct WorkQueue {
+        std::mutex mu;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool runOne();          // Run one task from our own deque or a stolen one
+    void workerLoop(size_t id);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;   // One per worker, at least one
     std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
-    std::mutex queue_mutex;
+    std::mutex sleepMutex;
     std::condition_variable condition;
+    std::atomic<size_t> queued{0};      // Tasks waiting in any deque
+    std::atomic<size_t> nextQueue{0};   // Round-robin target for external submits
     bool stop;
 };
 
@@ -28,10 +57,13 @@ template<class F>
 auto ThreadPool::enqueue(F&& f) -> std::future<decltype(f())> {
     auto task = std::make_shared<std::packaged_task<decltype(f())()>>(std::forward<F>(f));
     std::future<decltype(f())> res = task->get_future();
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        tasks.emplace([task]() { (*task)(); });
-    }
-    condition.notify_one();
+    submit([task]() { (*task)(); });
     return res;
 }
+
+template<class Pred>
+void ThreadPool::helpUntil(Pred done) {
+    while (!done()) {
+        if (!runOne()) std::this_thread::yield();
+    }
+}
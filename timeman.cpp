@@ -0,0 +1,58 @@
+// timeman.cpp
+// Time limits for a search and the timer that enforces the hard one.
+
+#include "timeman.h"
+
+#include <algorithm>
+
+TimeLimits computeTimeLimits(int remaining, int inc, int movestogo, int movetime, int defaultMs) {
+    if (movetime > 0) return { movetime, movetime };
+    if (remaining <= 0) return { defaultMs, defaultMs };
+
+    int slices = movestogo > 0 ? movestogo : TIME_SLICES;
+    int soft = std::max(TIME_MIN_MS, remaining / slices + inc / 2);
+    int hard = std::max(soft, std::min(soft * TIME_HARD_FACTOR, remaining / TIME_HARD_FRACTION));
+    return { soft, hard };
+}
+
+DeadlineTimer::~DeadlineTimer() {
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        quit = true;
+    }
+    cv.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+void DeadlineTimer::start(std::chrono::steady_clock::time_point at, std::atomic<bool>& stop) {
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        target = &stop;
+        deadline = at;
+        if (!thread.joinable()) thread = std::thread(&DeadlineTimer::run, this);
+    }
+    cv.notify_all();
+}
+
+void DeadlineTimer::cancel() {
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        target = nullptr;
+    }
+    cv.notify_all();
+}
+
+// Flags are only set with mu held, so none is set after cancel() or a new start()
+void DeadlineTimer::run() {
+    std::unique_lock<std::mutex> lk(mu);
+    while (!quit) {
+        if (!target)
+            cv.wait(lk);
+        else if (std::chrono::steady_clock::now() >= deadline) {
+            target->store(true, std::memory_order_relaxed);
+            target = nullptr;
+        }
+        else
+            cv.wait_until(lk, deadline);
+    }
+}
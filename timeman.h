@@ -0,0 +1,52 @@
+// timeman.h
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#define TIME_SLICES         30  // Share of the clock per move when there is no movestogo
+#define TIME_MIN_MS         50
+#define TIME_HARD_FACTOR    3   // The hard limit may stretch the soft one this many times,
+#define TIME_HARD_FRACTION  4   // but never past this fraction of the remaining time
+
+// Time for one search. Iterative deepening starts no new iteration after the soft limit,
+// and the search is aborted at the hard limit.
+struct TimeLimits {
+    int softMs;
+    int hardMs;
+};
+
+// Limits from the "go" parameters of the side to move: its remaining clock time and
+// increment (-1 and 0 when not given), movestogo (0 for sudden death) and movetime
+// (-1 when not given). defaultMs is used when there is neither movetime nor a clock.
+TimeLimits computeTimeLimits(int remaining, int inc, int movestogo, int movetime, int defaultMs);
+
+// Sets a stop flag when a deadline passes, so the searching threads only have to read
+// the flag instead of the clock. Its thread is started by the first start() and then
+// sleeps until the next one, so a search does not create a thread. start() arms the
+// timer, replacing any earlier deadline; cancel() disarms it, and once it returns the
+// flag is no longer touched. The destructor ends the thread.
+class DeadlineTimer {
+public:
+    DeadlineTimer() = default;
+    ~DeadlineTimer();
+    DeadlineTimer(const DeadlineTimer&) = delete;
+    DeadlineTimer& operator=(const DeadlineTimer&) = delete;
+
+    void start(std::chrono::steady_clock::time_point deadline, std::atomic<bool>& stop);
+    void cancel();
+
+private:
+    void run();
+
+    std::thread thread;
+    std::mutex mu;
+    std::condition_variable cv;
+    std::atomic<bool>* target = nullptr;    // Flag to set; null while disarmed
+    std::chrono::steady_clock::time_point deadline;
+    bool quit = false;
+};
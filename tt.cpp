@@ -0,0 +1,120 @@
+// tt.cpp
+// Shared, lock-free transposition table.
+
+#include "tt.h"
+
+#include <algorithm>
+
+TransTable g_tt;
+
+namespace {
+    // Packed data word layout:
+    //   bits  0-15  best move (PackedMove)
+    //   bits 16-31  score (int16)
+    //   bits 32-39  depth
+    //   bits 40-41  flag
+    //   bits 42-47  generation
+    // An all-zero word is an empty slot; stored entries always have depth >= 1.
+    uint64_t pack(int score, int depth, uint8_t flag, uint8_t generation, PackedMove best) {
+        return (uint64_t)best.data
+             | (uint64_t)(uint16_t)(int16_t)score << 16
+             | (uint64_t)(uint8_t)depth << 32
+             | (uint64_t)(flag & 3) << 40
+             | (uint64_t)(generation & 63) << 42;
+    }
+
+    int depthOf(uint64_t data)      { return (data >> 32) & 0xFF; }
+    uint8_t generationOf(uint64_t data) { return (data >> 42) & 63; }
+    PackedMove moveOf(uint64_t data) { PackedMove m; m.data = (uint16_t)data; return m; }
+}
+
+TransTable::TransTable(size_t megabytes) {
+    resize(megabytes);
+}
+
+void TransTable::resize(size_t megabytes) {
+    size_t clusters = std::max<size_t>(1, megabytes * 1024 * 1024 / sizeof(Cluster));
+    table = std::vector<Cluster>(clusters);
+    generation = 0;
+}
+
+void TransTable::clear() {
+    for (auto& c : table)
+        for (auto& s : c.slots) {
+            s.keyXorData.store(0, std::memory_order_relaxed);
+            s.data.store(0, std::memory_order_relaxed);
+        }
+    generation = 0;
+}
+
+void TransTable::newSearch() {
+    generation = (generation + 1) & 63;
+}
+
+TransTable::Cluster& TransTable::clusterFor(uint64_t key) const {
+    // Map the key onto [0, size) with a multiply, so any table size works
+    size_t i = (size_t)(((unsigned __int128)key * table.size()) >> 64);
+    return const_cast<Cluster&>(table[i]);
+}
+
+bool TransTable::probe(uint64_t key, TTEntry& out) const {
+    Cluster& c = clusterFor(key);
+    for (auto& s : c.slots) {
+        uint64_t data = s.data.load(std::memory_order_relaxed);
+        if (data != 0 && (s.keyXorData.load(std::memory_order_relaxed) ^ data) == key) {
+            out.key   = key;
+            out.best  = moveOf(data);
+            out.score = (int16_t)(data >> 16);
+            out.depth = (uint8_t)depthOf(data);
+            out.flag  = (data >> 40) & 3;
+            out.age   = generationOf(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TransTable::store(uint64_t key, int score, int depth, uint8_t flag, PackedMove best) {
+    Cluster& c = clusterFor(key);
+    Slot* victim = nullptr;
+    int victimValue = 0;
+    uint64_t old = 0;
+
+    for (auto& s : c.slots) {
+        uint64_t data = s.data.load(std::memory_order_relaxed);
+        if (data != 0 && (s.keyXorData.load(std::memory_order_relaxed) ^ data) == key) {
+            // Same position: keep a deeper result from this search unless ours is exact
+            if (flag != TT_EXACT && generationOf(data) == generation && depth + 2 < depthOf(data))
+                return;
+            victim = &s;
+            old = data;
+            break;
+        }
+        // Value of keeping this slot: its depth, less 8 plies per generation of age
+        int value = data == 0 ? -1000 : depthOf(data) - 8 * ((generation - generationOf(data)) & 63);
+        if (!victim || value < victimValue) {
+            victim = &s;
+            victimValue = value;
+        }
+    }
+
+    // A fail-low has no best move; keep the one already stored for this position
+    PackedMove move = best;
+    if (move.isNull() && old != 0) move = moveOf(old);
+
+    uint64_t data = pack(score, depth, flag, generation, move);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->keyXorData.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TransTable::hashfull() const {
+    int used = 0, sampled = 0;
+    size_t n = std::min<size_t>(table.size(), 1000 / CLUSTER_SIZE);
+    for (size_t i = 0; i < n; ++i)
+        for (auto& s : table[i].slots) {
+            uint64_t data = s.data.load(std::memory_order_relaxed);
+            if (data != 0 && generationOf(data) == generation) used++;
+            sampled++;
+        }
+    return sampled ? used * 1000 / sampled : 0;
+}
@@ -0,0 +1,68 @@
+// tt.h
+
+#pragma once
+
+#include "engine.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// TTEntry::flag says how the stored score bounds the true score
+#define TT_EXACT    0   // Score inside the window: exact
+#define TT_ALPHA    1   // Failed low: score is an upper bound
+#define TT_BETA     2   // Failed high: score is a lower bound
+
+// One probed transposition table entry, unpacked
+struct TTEntry {
+    uint64_t key=0;
+    int16_t  score=0;
+    uint8_t  depth=0;
+    uint8_t  flag=0;   // TT_EXACT, TT_ALPHA or TT_BETA
+    PackedMove best{}; // Match it against generated moves before playing it
+    uint8_t  age=0;    // Search generation that stored the entry
+};
+
+// Transposition table shared by every search thread.
+//
+// Entries are grouped in 64-byte clusters of four, so a probe touches one cache line.
+// Each slot holds two 64-bit words: the packed entry data and the key XORed with that
+// data. Both words are read and written with relaxed atomics and no lock; a slot torn
+// by two threads writing at once fails the key check (key ^ data != key) and reads as
+// a miss, so a thread never acts on a mix of two entries.
+//
+// Replacement prefers the slot with the same key, then the empty or least valuable
+// slot, where older generations lose value quickly so stale entries are reused first.
+class TransTable {
+public:
+    explicit TransTable(size_t megabytes = 16);
+
+    void resize(size_t megabytes);  // Reallocates and clears; no search may be running
+    void clear();
+    void newSearch();               // Start a new generation, call once per "go"
+
+    bool probe(uint64_t key, TTEntry& out) const;
+    void store(uint64_t key, int score, int depth, uint8_t flag, PackedMove best);
+
+    int hashfull() const;           // Permille of sampled slots used by this generation
+
+private:
+    static constexpr int CLUSTER_SIZE = 4;
+
+    struct Slot {
+        std::atomic<uint64_t> keyXorData{0};
+        std::atomic<uint64_t> data{0};
+    };
+
+    struct alignas(64) Cluster {
+        Slot slots[CLUSTER_SIZE];
+    };
+
+    Cluster& clusterFor(uint64_t key) const;
+
+    std::vector<Cluster> table;
+    uint8_t generation = 0;         // 6 bits, wraps
+};
+
+extern TransTable g_tt; // Sized by the UCI Hash option
@@ -1,4 +1,4 @@
-// uci.cpp — UCI loop with PV, info metrics, currmove progress, and file logging
+// uci.cpp — UCI loop with Lazy SMP search, PV, info metrics, and file logging
 
 #include "uci.h"
 #include "engine.h"
@@ -6,22 +6,23 @@
 #include "openingbook.h"
 #include "fen.h"
 #include "search.h"
+#include "tt.h"
 #include "thread_context.h"
-#include "uci_root_merge.h"
+#include "smp.h"
+#include "timeman.h"
 
 #include <iostream>
 #include <sstream>
 #include <thread>
+#include <future>
 #include <atomic>
 #include <chrono>
 #include <fstream>
 #include <vector>
-#include <limits>
 #include <cctype>
 #include <algorithm>
-#include <mutex>
+#include <memory>
 
-static const int INF = std::numeric_limits<int>::max();
 
 // ---------- File-based logging ----------
 static std::ofstream logfile("engine_log.txt", std::ios::app);
@@ -29,11 +30,17 @@ static std::ofstream logfile("engine_log.txt", std::ios::app);
 
 // ---------- UCI globals ----------
 std::atomic<bool> stopSearch(false);
-std::thread searchThread;
+DeadlineTimer searchTimer;                  // Sets stopSearch at the hard limit
+std::unique_ptr<ThreadPool> searchWorker;   // The search thread, kept between searches
+std::future<void> searchDone;               // The search in progress, if any
 OpeningBook openingBook;
+LazySMP smp;            // Helper threads; the search thread is the main Lazy SMP thread
+std::unique_ptr<ThreadPool> splitPool;  // Workers for the YBWC search mode
 
 // ---------- UCI configurable options ---------------------
 int hashSizeMB = 16;
+int threadCount = (int)std::max(1u, std::thread::hardware_concurrency());
+bool useYBWC = false;   // SearchMode: Lazy SMP (default) or YBWC split points
 std::string bookFile = "book.bin";
 bool useBook = true;
 
@@ -46,8 +53,21 @@ static std::string pvToUciString(const std::vector<Move>& pv) {
     return oss.str();
 }
 
-static void joinSearchThread() {
-    if (searchThread.joinable()) searchThread.join();
+static void waitForSearch() {
+    if (searchDone.valid()) searchDone.get();
+}
+
+// Start the helper threads for the current Threads and SearchMode options.
+// No search may be running.
+static void configureThreads() {
+    if (useYBWC) {
+        smp.setHelpers(0);
+        if (!splitPool || (int)splitPool->size() != threadCount - 1)
+            splitPool = std::make_unique<ThreadPool>(threadCount - 1);
+    } else {
+        splitPool.reset();
+        smp.setHelpers(threadCount - 1);
+    }
 }
 
 static inline std::string trim(std::string s) {
@@ -61,6 +81,8 @@ void runUciLoop() {
     std::string line;
 
     openingBook.load("book.bin"); // Load once
+    searchWorker = std::make_unique<ThreadPool>(1);
+    configureThreads();
 
     while (std::getline(std::cin, line)) {
         std::istringstream iss(line);
@@ -70,6 +92,8 @@ void runUciLoop() {
             std::cout << "id name Modular Chess Engine\n";
             std::cout << "id author Ivan Bell\n";
             std::cout << "option name Hash type spin default 16 min 1 max 512" << std::endl;
+            std::cout << "option name Threads type spin default " << threadCount << " min 1 max 256" << std::endl;
+            std::cout << "option name SearchMode type combo default LazySMP var LazySMP var YBWC" << std::endl;
             std::cout << "option name Book type string default book.bin" << std::endl;
             std::cout << "option name UseBook type check default true" << std::endl;
             std::cout << "uciok\n" << std::flush;
@@ -80,6 +104,8 @@ void runUciLoop() {
         } else if (token == "setoption") {
             // Expected formats:
             // setoption name Hash value 64
+            // setoption name Threads value 8
+            // setoption name SearchMode value YBWC
             // setoption name Book value mybook.bin
             // setoption name UseBook value false
             std::string word, name, value;
@@ -100,8 +126,25 @@ void runUciLoop() {
 
             if (name == "Hash") {
                 try { hashSizeMB = std::max(1, std::min(512, std::stoi(value))); } catch(...) {}
+                stopSearch = true;
+                waitForSearch();
+                g_tt.resize(hashSizeMB);
                 LOG("Hash size set to " + std::to_string(hashSizeMB) + " MB");
 
+            } else if (name == "Threads") {
+                try { threadCount = std::max(1, std::min(256, std::stoi(value))); } catch(...) {}
+                stopSearch = true;
+                waitForSearch();
+                configureThreads();
+                LOG("Threads set to " + std::to_string(threadCount));
+
+            } else if (name == "SearchMode") {
+                useYBWC = (value == "YBWC");
+                stopSearch = true;
+                waitForSearch();
+                configureThreads();
+                LOG(std::string("Search mode set to ") + (useYBWC ? "YBWC" : "LazySMP"));
+
             } else if (name == "Book") {
                 bookFile = value;
                 LOG("Book path set to " + bookFile);
@@ -119,7 +162,9 @@ void runUciLoop() {
         } else if (token == "ucinewgame") {
             board = getInitialBoard();
             stopSearch = false;
-            joinSearchThread();
+            waitForSearch();
+            g_tt.clear();
+            newGame();
             LOG("New game initialized");
 
         } else if (token == "position") {
@@ -141,21 +186,13 @@ void runUciLoop() {
                 else if (sub == "movestogo")  iss >> movestogo;
             }
 
-            // Simple time manager
-            int timePerMoveMs = 10000; // default
-            if (movetime > 0) {
-                timePerMoveMs = movetime;
-            } else {
-                int remaining = board.whiteToMove ? wtime : btime;
-                int inc       = board.whiteToMove ? winc  : binc;
-                if (remaining > 0) {
-                    int slices = (movestogo > 0 ? movestogo : 30);
-                    timePerMoveMs = remaining / std::max(1, slices) + inc / 2;
-                    timePerMoveMs = std::max(50, timePerMoveMs); // some floor
-                }
-            }
+            // Soft and hard time limits, 10 s without a clock
+            TimeLimits limits = computeTimeLimits(board.whiteToMove ? wtime : btime,
+                                                  board.whiteToMove ? winc : binc,
+                                                  movestogo, movetime, 10000);
             if (depthLimit <= 0) depthLimit = 12; // default cap
-            LOG("Search budget: " + std::to_string(timePerMoveMs) + "ms, depth cap " + std::to_string(depthLimit));
+            LOG("Search budget: " + std::to_string(limits.softMs) + "ms soft, "
+                + std::to_string(limits.hardMs) + "ms hard, depth cap " + std::to_string(depthLimit));
 
             // Opening book
             if (useBook) {
@@ -171,163 +208,88 @@ void runUciLoop() {
                 }
             }
 
-            // Launch search thread with iterative deepening, PV, info metrics,
-            // currmove updates, and thread-local heuristic merge at root.
+            // Hand the search to the search thread. It runs iterative deepening on the root,
+            // owns the time control and reports bestmove, while the Lazy SMP helpers search
+            // the same root and pass their results to it through the shared transposition
+            // table g_tt. In YBWC mode there are no helpers; instead interior nodes split
+            // their moves over splitPool, with the search thread taking part.
+            // searchTimer sets stopSearch at the hard limit, which stops every searching thread.
+            // All these threads live as long as the engine, so their history and killer
+            // tables carry over from one move to the next, and the timer's thread just
+            // sleeps between searches.
             stopSearch = false;
-            joinSearchThread();
-            searchThread = std::thread([board, timePerMoveMs, depthLimit]() {
+            waitForSearch();
+            g_tt.newSearch();
+            resetSearchStats();
+            searchDone = searchWorker->enqueue([board, limits, depthLimit]() {
+                g_ctx.prepareSearch();
                 auto start   = std::chrono::steady_clock::now();
-                auto deadline = start + std::chrono::milliseconds(timePerMoveMs);
-                std::atomic<bool> stop(false);
+                auto softDeadline = start + std::chrono::milliseconds(limits.softMs);
+                auto deadline = start + std::chrono::milliseconds(limits.hardMs);
 
-                Move bestMove{};
-                int bestEval = 0;
-
-                // Prepare root move list (so we can emit currmove/currmovenumber)
                 auto rootMoves = generateMoves(board);
                 if (rootMoves.empty()) {
                     std::cout << "bestmove 0000" << std::endl << std::flush;
                     return;
                 }
+                searchTimer.start(deadline, stopSearch);
+
+                Move bestMove = rootMoves.front(); // Played if depth 1 does not finish
+                int bestEval = 0;
 
-                RootAggregate agg(1u<<20);
-                std::mutex mergeMu;
+                smp.start(board, depthLimit, stopSearch);
 
                 for (int d = 1; d <= depthLimit; ++d) {
-                    if (std::chrono::steady_clock::now() >= deadline || stopSearch.load()) break;
-
-                    // (Optional) ordering of rootMoves can use agg.{history, killers}
-                    // after d>1 to refine ordering.
-
-                    // Track best at this depth
-                    Move depthBest{}; int  depthBestEval = -INF;
-                    std::vector<Move> depthBestPV;
-
-                    // Iterate root moves, emitting currmove/currmovenumber
-                    int rootIdx = 0;
-                    // Simple parallel for each root move chunk
-                    std::atomic<size_t> next{0};
-                    const size_t N = rootMoves.size();
-                    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
-                    std::vector<std::thread> pool;
-                    pool.reserve(threads);
-                    std::mutex bestMu;
-
-                    auto worker = [&]() {
-                        // Ensure the thread-local ctx starts clean for this root iteration
-                        g_ctx.resetAll();
-                        g_ctx.age = (uint16_t)d;
-                        for (;;) {
-                            size_t i = next.fetch_add(1, std::memory_order_relaxed);
-                            if (i >= N) break;
-                            const auto& rootMove = rootMoves[i];
-                            int myIdx = (int)(i+1);
-
-                            // Reset ctx for each repetition
-                            g_ctx.resetAll();
-                            g_ctx.age = 0;
-
-                            // Live progress line BEFORE we start searching this move
-                            uint64_t nodesNow = g_nodes.load(std::memory_order_relaxed);
-                            uint64_t msNow = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
-                                                std::chrono::steady_clock::now() - start).count();
-                            uint64_t npsNow = msNow ? (nodesNow * 1000ULL) / msNow : nodesNow * 1000ULL;
-
-                            std::cout << "info currmove " << moveToUci(rootMove)
-                                    << " currmovenumber " << myIdx
-                                    << " time " << msNow
-                                    << " nodes " << nodesNow
-                                    << " nps " << npsNow
-                                    << std::endl;
-
-                            if (std::chrono::steady_clock::now() >= deadline || stopSearch.load()) break;
-
-                            // Search this root move at depth d
-                            BoardData next = applyMove(board, rootMove);
-                            g_nodes.store(0, std::memory_order_relaxed); // measure per-move if you like (optional)
-                            std::vector<Move> childPV;
-                            int alpha = -INF, beta = INF;
-
-                            int eval = alphabetaTimed(
-                                next,           // position after rootMove
-                                d - 1,          // remaining depth
-                                alpha, beta,
-                                !board.whiteToMove,
-                                deadline, stop,
-                                childPV
-                            );
-
-                            // Build PV = [rootMove] + childPV
-                            std::vector<Move> pv; pv.reserve(1 + childPV.size());
-                            pv.push_back(rootMove);
-                            pv.insert(pv.end(), childPV.begin(), childPV.end());
-                            {
-                                // Update best line at this depth
-                                std::lock_guard<std::mutex> lk(bestMu);
-                                if (eval > depthBestEval) {
-                                    depthBestEval = eval;
-                                    depthBest = rootMove;
-                                    depthBestPV = std::move(pv);
-                                }
-                            }
-                            // Merge this thread's local heuristic tables into the root aggregate
-                            {
-                                std::lock_guard<std::mutex> lk(mergeMu);
-                                agg.mergeFrom(g_ctx.history);
-                                agg.mergeFrom(g_ctx.killers);
-                                agg.mergeFrom(g_ctx.tt);
-                            }
-                            
-                            if (std::chrono::steady_clock::now() >= deadline) break;
-                        }
-                    };
-
-                    for (unsigned t=0; t<threads; ++t) pool.emplace_back(worker);
-                    for (auto& th : pool) th.join();
+                    // Past the soft limit the next iteration is unlikely to finish
+                    if (d > 1 && std::chrono::steady_clock::now() >= softDeadline) break;
+
+                    std::vector<Move> pv;
+                    int eval = aspirationSearch(board, d, bestEval, deadline, stopSearch, pv, splitPool.get());
+
+                    // An interrupted iteration is incomplete, keep the previous one
+                    if (stopSearch.load()) break;
+                    if (pv.empty()) break;
+
+                    bestMove = pv.front();
+                    bestEval = eval;
 
                     // Emit depth summary with PV + nodes/time/nps
                     uint64_t ms = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
                                       std::chrono::steady_clock::now() - start).count();
-                    uint64_t nodes = g_nodes.load(std::memory_order_relaxed);
+                    uint64_t nodes = collectSearchStats().nodes;
                     uint64_t nps   = ms ? (nodes * 1000ULL) / ms : nodes * 1000ULL;
 
-                    // Update global best from this depth
-                    if (!depthBestPV.empty()) {
-                        bestMove = depthBest;
-                        bestEval = depthBestEval;
-                        std::cout << "info depth " << d
-                                << " score cp " << bestEval
-                                << " time " << ms
-                                << " nodes " << nodes
-                                << " nps " << nps
-                                << " pv " << pvToUciString(depthBestPV)
-                                << std::endl;
-                    } else {
-                        // No PV (timeout or no legal line)
-                        std::cout << "info depth " << d
-                                << " score cp 0"
-                                << " time " << ms
-                                << " nodes " << nodes
-                                << " nps " << nps
-                                << " pv"
-                                << std::endl;
-                    }
-
-                    if (std::chrono::steady_clock::now() >= deadline) break;
+                    std::cout << "info depth " << d
+                            << " score cp " << bestEval
+                            << " time " << ms
+                            << " nodes " << nodes
+                            << " nps " << nps
+                            << " hashfull " << g_tt.hashfull()
+                            << " pv " << pvToUciString(pv)
+                            << std::endl;
                 }
 
+                // Stop the helpers before answering, so the next search starts clean
+                searchTimer.cancel();
+                stopSearch = true;
+                smp.wait();
+
+                SearchTotals totals = collectSearchStats();
+                LOG("Search used " + std::to_string(totals.nodes) + " nodes, "
+                    + std::to_string(totals.qnodes) + " in quiescence, "
+                    + std::to_string(totals.ttHits) + " TT hits");
                 LOG("Best move selected by search: " + moveToUci(bestMove));
                 std::cout << "bestmove " << moveToUci(bestMove) << std::endl << std::flush;
             });
 
         } else if (token == "stop") {
             stopSearch = true;
-            joinSearchThread();
+            waitForSearch();
             LOG("Search stopped");
 
         } else if (token == "quit") {
             stopSearch = true;
-            joinSearchThread();
+            waitForSearch();
             LOG("Engine quitting...");
             break;
         }
@@ -3,14 +3,14 @@
 #include "engine.h"
 #include "search.h"
 #include "fen.h"
+#include "tt.h"
+#include "thread_context.h"
 #include <iostream>
 #include <sstream>
 #include <atomic>
 #include <chrono>
 #include <vector>
-#include <limits>
 
-static const int INF = std::numeric_limits<int>::max();
 
 // This UCI loop ignores time controls, books, threads, and root-parallel search.
 // It uses EXACT depth search, single-thread, and prints PV + score.
@@ -43,20 +43,19 @@ void runUciLoop_Deterministic() {
             }
             if (depth < 1) depth = 1;
 
-            // Deterministic: single-thread, no time cutoff, no book
+            // Deterministic: single-thread, no time cutoff, no book, and an empty
+            // transposition table and per-thread tables (eval cache, history, killers,
+            // counter moves), so earlier searches cannot change the result
+            g_tt.clear();
+            g_ctx.resetAll();
             auto far_future = std::chrono::steady_clock::now() + std::chrono::minutes(1);
             std::atomic<bool> stop(false);
 
+            // Iterative deepening, so each depth has an aspiration window around the last
             std::vector<Move> pv;
-            int eval = alphabetaTimed(
-                board,
-                depth,
-                -INF, INF,
-                board.whiteToMove,
-                far_future,
-                stop,
-                pv
-            );
+            int eval = 0;
+            for (int d = 1; d <= depth; ++d)
+                eval = aspirationSearch(board, d, eval, far_future, stop, pv);
 
             // Emit one final "info" with PV
             std::cout << "info depth " << depth
@@ -3,21 +3,22 @@
 
 #include "uci.h"
 #include "engine.h"
-#include "search.h"        // alphabetaTimed(..., std::vector<Move>& pv), g_nodes (ok)
+#include "search.h"        // aspirationSearch(..., std::vector<Move>& pv)
 #include "openingbook.h"
 #include "fen.h"
+#include "tt.h"
+#include "thread_context.h"
+#include "timeman.h"
 
 #include <iostream>
 #include <sstream>
 #include <chrono>
 #include <atomic>
 #include <vector>
-#include <limits>
 #include <fstream>
 #include <cctype>
 #include <algorithm>
 
-static const int INF = std::numeric_limits<int>::max();
 
 // ---------- File logging (optional) ----------
 static std::ofstream logfile("engine_log_st.txt", std::ios::app);
@@ -83,6 +84,7 @@ void runUciLoop() {
 
             if (name == "Hash") {
                 try { hashSizeMB = std::max(1, std::min(512, std::stoi(value))); } catch (...) {}
+                g_tt.resize(hashSizeMB);
                 LOG("Hash size set to " + std::to_string(hashSizeMB) + " MB");
             } else if (name == "Book") {
                 bookFile = value;
@@ -97,6 +99,8 @@ void runUciLoop() {
 
         } else if (token == "ucinewgame") {
             board = getInitialBoard();
+            g_tt.clear();
+            newGame();
             LOG("New game initialized");
 
         } else if (token == "position") {
@@ -118,19 +122,10 @@ void runUciLoop() {
                 else if (sub == "movestogo") iss >> movestogo;
             }
 
-            // Time manager (very simple)
-            int timePerMoveMs = 1000;
-            if (movetime > 0) {
-                timePerMoveMs = movetime;
-            } else {
-                int remaining = board.whiteToMove ? wtime : btime;
-                int inc       = board.whiteToMove ? winc  : binc;
-                if (remaining > 0) {
-                    int slices = (movestogo > 0 ? movestogo : 30);
-                    timePerMoveMs = remaining / std::max(1, slices) + inc/2;
-                    timePerMoveMs = std::max(50, timePerMoveMs);
-                }
-            }
+            // Soft and hard time limits, 1 s without a clock
+            TimeLimits limits = computeTimeLimits(board.whiteToMove ? wtime : btime,
+                                                  board.whiteToMove ? winc : binc,
+                                                  movestogo, movetime, 1000);
             if (depthLimit <= 0) depthLimit = 12; // default cap
 
             // Opening book (optional)
@@ -149,19 +144,29 @@ void runUciLoop() {
                 }
             }
 
-            // Single-threaded iterative deepening with deadline
+            // Single-threaded iterative deepening. With no timer thread, the search itself
+            // notices the hard deadline, and sets stop, when it polls the clock.
+            g_tt.newSearch();
+            g_ctx.prepareSearch();
+            resetSearchStats();
             auto start    = std::chrono::steady_clock::now();
-            auto deadline = start + std::chrono::milliseconds(timePerMoveMs);
+            auto softDeadline = start + std::chrono::milliseconds(limits.softMs);
+            auto deadline = start + std::chrono::milliseconds(limits.hardMs);
             std::atomic<bool> stop(false);
 
-            Move bestMove{};
+            // Played if depth 1 does not finish; stays null only with no legal move
+            auto rootMoves = generateMoves(board);
+            Move bestMove = rootMoves.empty() ? Move{} : rootMoves.front();
             int  bestEval = 0;
 
             for (int d = 1; d <= depthLimit; ++d) {
-                if (std::chrono::steady_clock::now() >= deadline) break;
+                if (d > 1 && std::chrono::steady_clock::now() >= softDeadline) break;
 
                 std::vector<Move> pv;
-                int eval = alphabetaTimed(board, d, -INF, INF, board.whiteToMove, deadline, stop, pv);
+                int eval = aspirationSearch(board, d, bestEval, deadline, stop, pv);
+
+                // An interrupted iteration is incomplete, keep the previous one
+                if (stop.load()) break;
 
                 if (!pv.empty()) {
                     bestMove = pv.front();
@@ -170,8 +175,7 @@ void runUciLoop() {
                     // Emit UCI info line with nodes/time/nps if available
                     uint64_t ms = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
                                       std::chrono::steady_clock::now() - start).count();
-                    extern std::atomic<uint64_t> g_nodes;
-                    uint64_t nodes = g_nodes.load(std::memory_order_relaxed);
+                    uint64_t nodes = collectSearchStats().nodes;
                     uint64_t nps   = ms ? (nodes * 1000ULL) / ms : nodes * 1000ULL;
 
                     std::cout << "info depth " << d
@@ -179,6 +183,7 @@ void runUciLoop() {
                               << " time " << ms
                               << " nodes " << nodes
                               << " nps " << nps
+                              << " hashfull " << g_tt.hashfull()
                               << " pv " << pvToUci(pv)
                               << std::endl;
                 } else {